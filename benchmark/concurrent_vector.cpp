@@ -0,0 +1,200 @@
+#include <Dlink/concurrent_vector.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pushes the same elements from 1 to 64 threads into a vector guarded by a mutex, the way messages used to be kept, and
+// into a concurrent_vector, with and without a thread that scans the elements while they are pushed. The elements are
+// made before the clock starts, so only pushing them is measured. The pushes of every run are checked afterwards.
+//
+// Usage: concurrent_vector_benchmark [count of pushes = 1048576]
+
+#ifdef DLINK_MULTITHREADING
+namespace
+{
+	using element = std::shared_ptr<std::size_t>;
+
+	class locked_vector final
+	{
+	public:
+		void push_back(element&& value)
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			data_.push_back(std::move(value));
+		}
+		std::size_t scan() const
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			std::size_t result = 0;
+
+			for (const element& value : data_)
+			{
+				result += *value != 0;
+			}
+
+			return result;
+		}
+		std::size_t size() const
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			return data_.size();
+		}
+		const element& operator[](std::size_t index) const
+		{
+			return data_[index];
+		}
+
+	private:
+		std::vector<element> data_;
+		mutable std::mutex mutex_;
+	};
+
+	class lock_free_vector final : public dlink::concurrent_vector<element>
+	{
+	public:
+		std::size_t scan() const
+		{
+			std::size_t result = 0;
+
+			for (const element& value : *this)
+			{
+				result += *value != 0;
+			}
+
+			return result;
+		}
+	};
+
+	// Returns the nanoseconds per push, or a negative number if a push was lost or reordered.
+	template<typename Vector_>
+	double run(std::size_t count_of_threads, std::size_t count_of_pushes, bool scans)
+	{
+		const std::size_t pushes_per_thread = count_of_pushes / count_of_threads;
+		std::vector<std::vector<element>> inputs(count_of_threads);
+
+		for (std::size_t i = 0; i < count_of_threads; ++i)
+		{
+			for (std::size_t j = 0; j < pushes_per_thread; ++j)
+			{
+				inputs[i].push_back(std::make_shared<std::size_t>(i * pushes_per_thread + j + 1));
+			}
+		}
+
+		Vector_ vector;
+		std::atomic<std::size_t> started{ 0 };
+		std::atomic<bool> done{ false };
+		std::vector<std::thread> threads;
+		std::thread scanner;
+
+		if (scans)
+		{
+			scanner = std::thread([&vector, &done]
+			{
+				while (!done.load(std::memory_order_relaxed))
+				{
+					vector.scan();
+					std::this_thread::yield();
+				}
+			});
+		}
+
+		for (std::size_t i = 0; i < count_of_threads; ++i)
+		{
+			threads.emplace_back([&vector, &inputs, &started, count_of_threads, i]
+			{
+				++started;
+				while (started.load() < count_of_threads)
+				{
+					std::this_thread::yield();
+				}
+
+				for (element& value : inputs[i])
+				{
+					vector.push_back(std::move(value));
+				}
+			});
+		}
+
+		const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+		done.store(true, std::memory_order_relaxed);
+		if (scanner.joinable())
+		{
+			scanner.join();
+		}
+
+		// Every element is there once, and the ones of a thread are in the order it pushed them.
+		if (vector.size() != pushes_per_thread * count_of_threads)
+			return -1;
+
+		std::vector<std::size_t> last(count_of_threads, 0);
+		for (std::size_t i = 0; i < vector.size(); ++i)
+		{
+			const std::size_t value = *vector[i];
+			const std::size_t thread = (value - 1) / pushes_per_thread;
+
+			if (value <= last[thread])
+				return -1;
+
+			last[thread] = value;
+		}
+
+		return elapsed / static_cast<double>(pushes_per_thread * count_of_threads);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t count_of_pushes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1 << 20;
+
+	for (bool scans : { false, true })
+	{
+		std::printf("%s\n%8s %14s %14s %8s\n", scans ? "With a thread scanning:" : "Pushing only:", "threads", "mutex ns/push",
+					"lock-free ns", "speedup");
+
+		for (std::size_t count_of_threads : { 1, 2, 4, 8, 16, 32, 64 })
+		{
+			double locked = 1e30;
+			double lock_free = 1e30;
+
+			for (int i = 0; i < 3; ++i)
+			{
+				const double locked_time = run<locked_vector>(count_of_threads, count_of_pushes, scans);
+				const double lock_free_time = run<lock_free_vector>(count_of_threads, count_of_pushes, scans);
+
+				if (locked_time < 0 || lock_free_time < 0)
+				{
+					std::printf("A push was lost or reordered with %zu threads.\n", count_of_threads);
+					return 1;
+				}
+
+				locked = std::min(locked, locked_time);
+				lock_free = std::min(lock_free, lock_free_time);
+			}
+
+			std::printf("%8zu %14.1f %14.1f %7.2fx\n", count_of_threads, locked, lock_free, locked / lock_free);
+		}
+	}
+
+	return 0;
+}
+#else
+int main()
+{
+	std::puts("concurrent_vector is std::vector without DLINK_MULTITHREADING.");
+	return 0;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <Dlink/lexer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Classifies the same words with a std::map built from the keyword list, the way the lexer used to look keywords up, and
+// with find_keyword(). A third of the words are keywords; the rest are identifiers, some of which differ from a keyword
+// in one character or in length. Before anything is timed, both lookups are checked to agree on every word.
+//
+// Usage: keyword_benchmark [count of words = 4096]
+
+namespace
+{
+	using keyword_map = std::map<std::string_view, dlink::token_type>;
+
+	std::vector<std::string> make_words(std::size_t count_of_words)
+	{
+		static constexpr char characters[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+
+		std::mt19937 random(42);
+		std::uniform_int_distribution<std::size_t> keyword(0, std::size(dlink::keywords) - 1);
+		std::uniform_int_distribution<std::size_t> character(0, 25);
+		std::uniform_int_distribution<std::size_t> length(1, 12);
+		std::vector<std::string> words;
+
+		for (std::size_t i = 0; i < count_of_words; ++i)
+		{
+			switch (i % 6)
+			{
+			case 0:
+			case 1:
+				words.emplace_back(dlink::keywords[keyword(random)].first);
+				break;
+
+			case 2:
+			{
+				// A keyword with one character changed.
+				std::string word(dlink::keywords[keyword(random)].first);
+				word[std::uniform_int_distribution<std::size_t>(0, word.size() - 1)(random)] = characters[character(random)];
+				words.push_back(std::move(word));
+				break;
+			}
+
+			case 3:
+				// A keyword with a character after it.
+				words.push_back(std::string(dlink::keywords[keyword(random)].first) + characters[character(random)]);
+				break;
+
+			default:
+			{
+				std::string word(length(random), ' ');
+				for (char& c : word)
+				{
+					c = characters[std::uniform_int_distribution<std::size_t>(0, std::size(characters) - 2)(random)];
+				}
+
+				word[0] = characters[character(random)];
+				words.push_back(std::move(word));
+				break;
+			}
+			}
+		}
+
+		return words;
+	}
+
+	dlink::token_type find_in_map(const keyword_map& map, const std::string_view& word)
+	{
+		const keyword_map::const_iterator iter = map.find(word);
+		return iter == map.end() ? dlink::token_type::none : iter->second;
+	}
+
+	// Returns the nanoseconds per word, best of 5 runs.
+	template<typename Func_>
+	double measure(const std::vector<std::string>& words, Func_&& function)
+	{
+		double best = 1e30;
+		std::size_t sink = 0;
+
+		for (int i = 0; i < 5; ++i)
+		{
+			const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+			for (int j = 0; j < 200; ++j)
+			{
+				for (const std::string& word : words)
+				{
+					sink += static_cast<std::size_t>(function(word));
+				}
+			}
+
+			const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+			best = std::min(best, elapsed / static_cast<double>(words.size() * 200));
+		}
+
+		// Keeps the lookups from being optimized away.
+		if (sink == 1) std::puts("");
+
+		return best;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t count_of_words = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+
+	const keyword_map map(std::begin(dlink::keywords), std::end(dlink::keywords));
+	const std::vector<std::string> words = make_words(count_of_words);
+
+	// Every keyword is found by both, and every other word by neither.
+	for (const auto& [name, type] : dlink::keywords)
+	{
+		if (find_in_map(map, name) != type || dlink::find_keyword(name) != type)
+		{
+			std::printf("The lookups disagree on the keyword '%.*s'.\n", static_cast<int>(name.size()), name.data());
+			return 1;
+		}
+	}
+	for (const std::string& word : words)
+	{
+		if (find_in_map(map, word) != dlink::find_keyword(word))
+		{
+			std::printf("The lookups disagree on the word '%s'.\n", word.c_str());
+			return 1;
+		}
+	}
+
+	const double map_time = measure(words, [&map](const std::string_view& word)
+	{
+		return find_in_map(map, word);
+	});
+	const double table_time = measure(words, [](const std::string_view& word)
+	{
+		return dlink::find_keyword(word);
+	});
+
+	std::printf("%8s %14s %14s %8s\n", "words", "map ns/token", "table ns", "speedup");
+	std::printf("%8zu %14.1f %14.1f %7.2fx\n", words.size(), map_time, table_time, map_time / table_time);
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include <Dlink/compiler_metadata.hpp>
+#include <Dlink/threading.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Runs a stage over jobs whose sizes follow a skewed distribution, once split into equal ranges of jobs per thread as
+// the threads used to be handed them, and once scheduled by size on the pool. A job sleeps for one microsecond per unit
+// of size, so that the makespans only depend on the schedule and not on how many cores the machine has.
+//
+// Usage: thread_pool_benchmark [count of threads = 8]
+
+namespace
+{
+	std::vector<std::uint64_t> make_sizes(const std::string& distribution)
+	{
+		std::mt19937 random(42);
+		std::lognormal_distribution<double> lognormal(6.5, 1.5);
+		std::vector<std::uint64_t> sizes;
+
+		if (distribution == "uniform")
+		{
+			sizes.assign(64, 2000);
+		}
+		else if (distribution == "one huge")
+		{
+			sizes.assign(63, 500);
+			sizes.insert(sizes.begin() + 5, 40000);
+		}
+		else if (distribution == "lognormal" || distribution == "sorted")
+		{
+			for (int i = 0; i < 64; ++i)
+			{
+				sizes.push_back(static_cast<std::uint64_t>(lognormal(random)) + 1);
+			}
+
+			if (distribution == "sorted")
+			{
+				std::sort(sizes.rbegin(), sizes.rend());
+			}
+		}
+		else if (distribution == "tiny")
+		{
+			sizes.assign(2000, 1);
+		}
+
+		return sizes;
+	}
+
+	template<typename Func_>
+	double measure(Func_&& function)
+	{
+		double best = 1e30;
+
+		for (int i = 0; i < 5; ++i)
+		{
+			const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+		}
+
+		return best;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t count_of_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+
+	dlink::compiler_options options;
+	options.count_of_threads(static_cast<std::int32_t>(count_of_threads));
+	dlink::compiler_metadata metadata(options);
+
+	std::printf("%-10s %8s %10s %10s %8s\n", "sizes", "threads", "equal ms", "sized ms", "speedup");
+
+	for (const char* distribution : { "uniform", "one huge", "lognormal", "sorted", "tiny" })
+	{
+		const std::vector<std::uint64_t> sizes = make_sizes(distribution);
+		const auto job = [&sizes](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				// Tiny jobs cost only what scheduling them costs.
+				if (sizes[i] > 1)
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(sizes[i]));
+				}
+			}
+
+			return true;
+		};
+
+		const dlink::threading_info equal_info = dlink::get_threading_info(metadata, sizes.size());
+		const double equal = measure([&]
+		{
+			dlink::thread_pool::shared(equal_info.count_of_threads).run([&](std::size_t thread)
+			{
+				const std::size_t begin = thread * equal_info.average;
+				const std::size_t end = begin + equal_info.average + (thread == equal_info.count_of_threads - 1 ? equal_info.remainder : 0);
+
+				return job(begin, end);
+			}, 0, equal_info.count_of_threads, equal_info.count_of_threads);
+		});
+
+		const dlink::threading_info sized_info = dlink::get_threading_info(metadata, sizes);
+		const double sized = measure([&]
+		{
+			dlink::parallel(job, sized_info);
+		});
+
+		std::printf("%-10s %8zu %10.3f %10.3f %7.2fx\n", distribution, sized_info.count_of_threads, equal, sized, equal / sized);
+	}
+
+	return 0;
+}
\ No newline at end of file
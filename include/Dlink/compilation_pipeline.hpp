@@ -7,6 +7,8 @@
 #include <Dlink/extlib/json.hpp>
 
 #include <ostream>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace dlink
@@ -31,17 +33,24 @@ namespace dlink
 		void dump_messages() const;
 		void dump_messages(std::ostream& stream) const;
 
+		void add_input(const std::string_view& path, std::string&& codes);
+		void add_input(const std::string_view& path, const std::string_view& codes);
+
 		bool decode();
 		bool decode_singlethread();
 		bool preprocess();
 		bool preprocess_singlethread();
 		bool lex();
 		bool lex_singlethread();
+		bool lex_fused();
+		bool lex_fused_singlethread();
 
 		bool compile_until_preprocessing();
 		bool compile_until_preprocessing_singlethread();
 		bool compile_until_lexing();
 		bool compile_until_lexing_singlethread();
+		bool compile_until_lexing_fused();
+		bool compile_until_lexing_fused_singlethread();
 
 		nlohmann::json dump_sources() const;
 
@@ -51,6 +60,19 @@ namespace dlink
 		const std::vector<source>& sources() const noexcept;
 		std::vector<source>& sources() noexcept;
 
+	private:
+		// A stage that a source goes through on its own. The stages of a source run in order, but different sources can be
+		// in different stages at the same time. Stages that need every source to be through an earlier one, like resolving
+		// names across files, are the only place a barrier belongs.
+		using stage_ = bool (source::*)(compiler_metadata& metadata);
+
+		std::vector<stage_> stages_(bool lex, bool fused) const;
+		std::size_t add_inputs_();
+		bool compile_singlethread_(const std::vector<stage_>& stages);
+#ifdef DLINK_MULTITHREADING
+		bool compile_(const std::vector<stage_>& stages);
+#endif
+
 	private:
 		compiler_metadata metadata_;
 		std::vector<source> sources_;
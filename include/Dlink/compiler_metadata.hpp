@@ -2,10 +2,34 @@
 #define DLINK_HEADER_COMPILER_METADATA_HPP
 
 #include <Dlink/compiler_options.hpp>
+#include <Dlink/interner.hpp>
 #include <Dlink/message.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef DLINK_MULTITHREADING
+#	include <mutex>
+#endif
+
 namespace dlink
 {
+	// How a stage that ran in parallel was scheduled. The predicted makespan is how long the busiest thread would have
+	// taken if every byte cost the same, at the rate the tasks of the stage actually went through them.
+	struct stage_schedule
+	{
+		std::string stage;
+		std::size_t count_of_threads;
+		std::size_t count_of_tasks;
+		std::uint64_t size;
+		std::uint64_t predicted_size;		// The bytes given to the busiest thread
+		double predicted_makespan;			// In seconds, as are the others
+		double actual_makespan;
+		double busy_time;					// The time all the tasks took together
+	};
+
 	class compiler_metadata final
 	{
 	public:
@@ -27,10 +51,21 @@ namespace dlink
 		dlink::messages& messages() noexcept;
 		const compiler_options& options() const noexcept;
 		compiler_options& options() noexcept;
+		const dlink::interner& interner() const noexcept;
+		dlink::interner& interner() noexcept;
+
+		void add_schedule(stage_schedule&& schedule);
+		std::vector<stage_schedule> schedules() const;
 
 	private:
 		dlink::messages messages_;
 		compiler_options options_;
+		dlink::interner interner_;
+		std::vector<stage_schedule> schedules_;
+
+#ifdef DLINK_MULTITHREADING
+		mutable std::mutex schedules_mutex_;
+#endif
 	};
 }
 
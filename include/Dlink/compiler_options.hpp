@@ -3,6 +3,7 @@
 
 #include <Dlink/encoding.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <ostream>
@@ -59,6 +60,14 @@ namespace dlink
 		std::int32_t count_of_threads() const noexcept;
 #ifdef DLINK_MULTITHREADING
 		void count_of_threads(std::int32_t new_count_of_threads) noexcept;
+#endif
+		std::size_t read_ahead_depth() const noexcept;
+#ifdef DLINK_MULTITHREADING
+		void read_ahead_depth(std::size_t new_read_ahead_depth) noexcept;
+#endif
+		std::size_t lex_chunk_size() const noexcept;
+#ifdef DLINK_MULTITHREADING
+		void lex_chunk_size(std::size_t new_lex_chunk_size) noexcept;
 #endif
 		const std::vector<std::string>& input_files() const noexcept;
 		const std::string& output_file() const noexcept;
@@ -68,6 +77,10 @@ namespace dlink
 
 		encoding input_encoding() const noexcept;
 		void input_encoding(encoding new_encoding_type) noexcept;
+		bool map_input() const noexcept;
+		void map_input(bool new_map_input) noexcept;
+		std::size_t stream_chunk_size() const noexcept;
+		void stream_chunk_size(std::size_t new_stream_chunk_size) noexcept;
 
 	private:
 		bool help_ = false;
@@ -75,6 +88,8 @@ namespace dlink
 
 #ifdef DLINK_MULTITHREADING
 		std::int32_t count_of_threads_ = 1;
+		std::size_t read_ahead_depth_ = default_read_ahead_depth;
+		std::size_t lex_chunk_size_ = default_lex_chunk_size;
 #endif
 		std::vector<std::string> input_files_;
 		std::string output_file_;
@@ -82,9 +97,13 @@ namespace dlink
 		std::map<std::string, std::string> macros_;
 
 		encoding input_encoding_ = encoding::none;
+		bool map_input_ = true;
+		std::size_t stream_chunk_size_ = 0;
 
 	public:
 		static constexpr std::int32_t max_count_of_threads = 128;
+		static constexpr std::size_t default_read_ahead_depth = 8;
+		static constexpr std::size_t default_lex_chunk_size = 1 << 20;
 	};
 	
 	bool parse_command_line(int argc, char** argv, compiler_options& options);
@@ -0,0 +1,517 @@
+#ifndef DLINK_HEADER_CONCURRENT_VECTOR_HPP
+#define DLINK_HEADER_CONCURRENT_VECTOR_HPP
+
+#include <vector>
+
+#ifdef DLINK_MULTITHREADING
+#	include <Dlink/system.hpp>
+
+#	include <array>
+#	include <atomic>
+#	include <cstddef>
+#	include <iterator>
+#	include <new>
+#	include <stdexcept>
+#	include <type_traits>
+#	include <utility>
+#endif
+
+namespace dlink
+{
+#ifdef DLINK_MULTITHREADING
+	// An append-only vector that any number of threads can push to and read from without a lock. The elements live in
+	// segments that double in size and are never moved, so a reference to an element stays valid until the element is
+	// removed. push_back reserves its index with a single atomic increment, and an element becomes visible once it and
+	// every element before it are constructed, so readers always see a prefix of the vector in push order.
+	// Removing elements, assigning and swapping must not run concurrently with anything else.
+	template<typename Ty_>
+	class concurrent_vector
+	{
+	private:
+		struct slot_
+		{
+			alignas(Ty_) unsigned char storage[sizeof(Ty_)];
+			std::atomic<bool> ready{ false };
+		};
+
+		template<typename ElementTy_>
+		class iterator_ final
+		{
+			friend class concurrent_vector;
+			template<typename>
+			friend class iterator_;
+
+		private:
+			using vector_type_ = std::conditional_t<std::is_const_v<ElementTy_>, const concurrent_vector, concurrent_vector>;
+
+		public:
+			using iterator_category = std::random_access_iterator_tag;
+			using value_type = std::remove_const_t<ElementTy_>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = ElementTy_*;
+			using reference = ElementTy_&;
+
+		public:
+			iterator_() noexcept = default;
+			template<typename OtherTy_, typename = std::enable_if_t<std::is_same_v<const OtherTy_, ElementTy_>>>
+			iterator_(const iterator_<OtherTy_>& iterator) noexcept
+				: vector_(iterator.vector_), index_(iterator.index_), current_(iterator.current_), segment_end_(iterator.segment_end_)
+			{}
+
+		private:
+			iterator_(vector_type_* vector, std::size_t index) noexcept
+				: vector_(vector), index_(index)
+			{
+				seek_();
+			}
+
+		public:
+			reference operator*() const noexcept
+			{
+				return *element_(*current_);
+			}
+			pointer operator->() const noexcept
+			{
+				return element_(*current_);
+			}
+			reference operator[](difference_type offset) const noexcept
+			{
+				return (*vector_)[index_ + offset];
+			}
+
+			iterator_& operator++() noexcept
+			{
+				if (++index_ == segment_end_)
+				{
+					seek_();
+				}
+				else
+				{
+					++current_;
+				}
+
+				return *this;
+			}
+			iterator_ operator++(int) noexcept
+			{
+				iterator_ result = *this;
+				++*this;
+				return result;
+			}
+			iterator_& operator--() noexcept
+			{
+				--index_;
+				seek_();
+				return *this;
+			}
+			iterator_ operator--(int) noexcept
+			{
+				iterator_ result = *this;
+				--*this;
+				return result;
+			}
+			iterator_& operator+=(difference_type offset) noexcept
+			{
+				index_ += offset;
+				seek_();
+				return *this;
+			}
+			iterator_& operator-=(difference_type offset) noexcept
+			{
+				index_ -= offset;
+				seek_();
+				return *this;
+			}
+			iterator_ operator+(difference_type offset) const noexcept
+			{
+				return iterator_(vector_, index_ + offset);
+			}
+			friend iterator_ operator+(difference_type offset, const iterator_& iterator) noexcept
+			{
+				return iterator + offset;
+			}
+			iterator_ operator-(difference_type offset) const noexcept
+			{
+				return iterator_(vector_, index_ - offset);
+			}
+			difference_type operator-(const iterator_& iterator) const noexcept
+			{
+				return static_cast<difference_type>(index_) - static_cast<difference_type>(iterator.index_);
+			}
+
+			bool operator==(const iterator_& iterator) const noexcept
+			{
+				return index_ == iterator.index_;
+			}
+			bool operator!=(const iterator_& iterator) const noexcept
+			{
+				return index_ != iterator.index_;
+			}
+			bool operator<(const iterator_& iterator) const noexcept
+			{
+				return index_ < iterator.index_;
+			}
+			bool operator>(const iterator_& iterator) const noexcept
+			{
+				return index_ > iterator.index_;
+			}
+			bool operator<=(const iterator_& iterator) const noexcept
+			{
+				return index_ <= iterator.index_;
+			}
+			bool operator>=(const iterator_& iterator) const noexcept
+			{
+				return index_ >= iterator.index_;
+			}
+
+		private:
+			// Caches the slot of the index and where its segment ends, so that stepping within a segment is an increment.
+			void seek_() noexcept
+			{
+				const std::size_t segment = segment_of_(index_);
+
+				current_ = vector_->segments_[segment].load(std::memory_order_acquire);
+				if (current_)
+				{
+					current_ += offset_of_(index_);
+				}
+
+				segment_end_ = (first_segment_size_ << (segment + 1)) - first_segment_size_;
+			}
+
+		private:
+			vector_type_* vector_ = nullptr;
+			std::size_t index_ = 0;
+			slot_* current_ = nullptr;
+			std::size_t segment_end_ = 0;
+		};
+
+	public:
+		using value_type = Ty_;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = Ty_&;
+		using const_reference = const Ty_&;
+		using pointer = Ty_*;
+		using const_pointer = const Ty_*;
+		using iterator = iterator_<Ty_>;
+		using const_iterator = iterator_<const Ty_>;
+
+	public:
+		concurrent_vector() noexcept
+		{
+			for (std::atomic<slot_*>& segment : segments_)
+			{
+				segment.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+		concurrent_vector(const concurrent_vector& vector)
+			: concurrent_vector()
+		{
+			for (const Ty_& element : vector)
+			{
+				push_back(element);
+			}
+		}
+		concurrent_vector(concurrent_vector&& vector) noexcept
+			: concurrent_vector()
+		{
+			swap(vector);
+		}
+		~concurrent_vector()
+		{
+			clear();
+
+			for (std::atomic<slot_*>& segment : segments_)
+			{
+				delete[] segment.load(std::memory_order_relaxed);
+			}
+		}
+
+	public:
+		concurrent_vector& operator=(const concurrent_vector& vector)
+		{
+			if (this != &vector)
+			{
+				concurrent_vector(vector).swap(*this);
+			}
+
+			return *this;
+		}
+		concurrent_vector& operator=(concurrent_vector&& vector) noexcept
+		{
+			if (this != &vector)
+			{
+				clear();
+				swap(vector);
+			}
+
+			return *this;
+		}
+		bool operator==(const concurrent_vector& vector) const
+		{
+			const size_type count = size();
+			if (count != vector.size())
+				return false;
+
+			for (size_type i = 0; i < count; ++i)
+			{
+				if (!((*this)[i] == vector[i]))
+					return false;
+			}
+
+			return true;
+		}
+		bool operator!=(const concurrent_vector& vector) const
+		{
+			return !(*this == vector);
+		}
+		// The index must be less than a size returned before.
+		reference operator[](size_type index) noexcept
+		{
+			return *element_(slot_at_(index));
+		}
+		const_reference operator[](size_type index) const noexcept
+		{
+			return *element_(slot_at_(index));
+		}
+
+	public:
+		reference at(size_type index)
+		{
+			if (index >= size())
+				throw std::out_of_range("The argument 'index' must be less than the size.");
+
+			return (*this)[index];
+		}
+		const_reference at(size_type index) const
+		{
+			if (index >= size())
+				throw std::out_of_range("The argument 'index' must be less than the size.");
+
+			return (*this)[index];
+		}
+		reference front() noexcept
+		{
+			return (*this)[0];
+		}
+		const_reference front() const noexcept
+		{
+			return (*this)[0];
+		}
+		reference back() noexcept
+		{
+			return (*this)[size() - 1];
+		}
+		const_reference back() const noexcept
+		{
+			return (*this)[size() - 1];
+		}
+
+		iterator begin() noexcept
+		{
+			return iterator(this, 0);
+		}
+		const_iterator begin() const noexcept
+		{
+			return const_iterator(this, 0);
+		}
+		const_iterator cbegin() const noexcept
+		{
+			return begin();
+		}
+		// The end of the elements visible when it is called, which later pushes don't move.
+		iterator end() noexcept
+		{
+			return iterator(this, size());
+		}
+		const_iterator end() const noexcept
+		{
+			return const_iterator(this, size());
+		}
+		const_iterator cend() const noexcept
+		{
+			return end();
+		}
+
+		bool empty() const noexcept
+		{
+			return size() == 0;
+		}
+		// Returns the count of the elements visible to the caller, which only grows while elements are pushed.
+		size_type size() const noexcept
+		{
+			size_type published = published_.load(std::memory_order_acquire);
+			const size_type reserved = reserved_.load(std::memory_order_acquire);
+
+			// The first pusher that finished after the published elements doesn't advance the size by itself, so whoever
+			// asks for the size next does.
+			while (published < reserved)
+			{
+				const slot_* const segment = segments_[segment_of_(published)].load(std::memory_order_acquire);
+
+				if (!segment || !segment[offset_of_(published)].ready.load(std::memory_order_acquire))
+					break;
+
+				++published;
+			}
+
+			size_type current = published_.load(std::memory_order_relaxed);
+			while (current < published &&
+				   !published_.compare_exchange_weak(current, published, std::memory_order_release, std::memory_order_relaxed))
+			{}
+
+			return published;
+		}
+		void reserve(size_type count)
+		{
+			if (count == 0)
+				return;
+
+			for (size_type segment = 0; segment <= segment_of_(count - 1); ++segment)
+			{
+				segment_(segment);
+			}
+		}
+
+		// Constructing an element must not throw, or the elements pushed after it never become visible.
+		void push_back(const Ty_& value)
+		{
+			emplace_back(value);
+		}
+		void push_back(Ty_&& value)
+		{
+			emplace_back(std::move(value));
+		}
+		template<typename... Args_>
+		reference emplace_back(Args_&&... args)
+		{
+			const size_type index = reserved_.fetch_add(1, std::memory_order_relaxed);
+			slot_& slot = segment_(segment_of_(index))[offset_of_(index)];
+
+			Ty_* const element = new(slot.storage) Ty_(std::forward<Args_>(args)...);
+			slot.ready.store(true, std::memory_order_release);
+
+			return *element;
+		}
+
+		void pop_back() noexcept
+		{
+			resize_down_(size() - 1);
+		}
+		void resize(size_type count)
+		{
+			if (count < size())
+			{
+				resize_down_(count);
+				return;
+			}
+
+			while (size() < count)
+			{
+				emplace_back();
+			}
+		}
+		// Keeps the segments, so pushing the elements again allocates nothing.
+		void clear() noexcept
+		{
+			resize_down_(0);
+		}
+		void swap(concurrent_vector& vector) noexcept
+		{
+			for (size_type i = 0; i < segment_count_; ++i)
+			{
+				slot_* const segment = segments_[i].load(std::memory_order_relaxed);
+
+				segments_[i].store(vector.segments_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+				vector.segments_[i].store(segment, std::memory_order_relaxed);
+			}
+
+			const size_type reserved = reserved_.load(std::memory_order_relaxed);
+			const size_type published = published_.load(std::memory_order_relaxed);
+
+			reserved_.store(vector.reserved_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			published_.store(vector.published_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			vector.reserved_.store(reserved, std::memory_order_relaxed);
+			vector.published_.store(published, std::memory_order_relaxed);
+		}
+
+	private:
+		static size_type segment_of_(size_type index) noexcept
+		{
+			// Shifting first can't overflow, so the segment is never negative.
+			return static_cast<size_type>(bit_width((index >> first_segment_bits_) + 1)) - 1;
+		}
+		static size_type offset_of_(size_type index) noexcept
+		{
+			return index + first_segment_size_ - (first_segment_size_ << segment_of_(index));
+		}
+		static Ty_* element_(const slot_& slot) noexcept
+		{
+			return std::launder(reinterpret_cast<Ty_*>(const_cast<unsigned char*>(slot.storage)));
+		}
+
+		slot_& slot_at_(size_type index) const noexcept
+		{
+			return segments_[segment_of_(index)].load(std::memory_order_acquire)[offset_of_(index)];
+		}
+		// Returns the segment, allocating it if no other thread has yet.
+		slot_* segment_(size_type segment)
+		{
+			slot_* current = segments_[segment].load(std::memory_order_acquire);
+			if (current)
+				return current;
+
+			slot_* const allocated = new slot_[first_segment_size_ << segment];
+			if (segments_[segment].compare_exchange_strong(current, allocated, std::memory_order_acq_rel, std::memory_order_acquire))
+				return allocated;
+
+			delete[] allocated;
+			return current;
+		}
+		// Destroys the elements from 'count' on.
+		void resize_down_(size_type count) noexcept
+		{
+			const size_type reserved = reserved_.load(std::memory_order_relaxed);
+
+			for (size_type i = count; i < reserved; ++i)
+			{
+				// A push whose segment couldn't be allocated left its index without one.
+				slot_* const segment = segments_[segment_of_(i)].load(std::memory_order_relaxed);
+				if (!segment)
+					continue;
+
+				slot_& slot = segment[offset_of_(i)];
+				if (slot.ready.load(std::memory_order_relaxed))
+				{
+					element_(slot)->~Ty_();
+					slot.ready.store(false, std::memory_order_relaxed);
+				}
+			}
+
+			reserved_.store(count, std::memory_order_relaxed);
+			published_.store(count, std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr size_type first_segment_bits_ = 4;
+		static constexpr size_type first_segment_size_ = size_type(1) << first_segment_bits_;
+		static constexpr size_type segment_count_ = sizeof(size_type) * 8 - first_segment_bits_ + 1;	// Enough for every index
+
+		std::array<std::atomic<slot_*>, segment_count_> segments_;
+		std::atomic<size_type> reserved_{ 0 };
+		mutable std::atomic<size_type> published_{ 0 };
+	};
+
+	template<typename Ty_>
+	void swap(concurrent_vector<Ty_>& lhs, concurrent_vector<Ty_>& rhs) noexcept
+	{
+		lhs.swap(rhs);
+	}
+#else
+	template<typename Ty_>
+	using concurrent_vector = std::vector<Ty_>;
+#endif
+}
+
+#endif
\ No newline at end of file
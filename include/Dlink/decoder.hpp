@@ -2,12 +2,13 @@
 #define DLINK_HEADER_DECODER_HPP
 
 #include <Dlink/compiler_metadata.hpp>
+#include <Dlink/encoding.hpp>
 #include <Dlink/source.hpp>
 #include <Dlink/system.hpp>
 
-#include <cstdio>
-#include <fstream>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -30,13 +31,61 @@ namespace dlink
 	public:
 		static bool decode(compiler_metadata& metadata, std::vector<source>& results);
 		static bool decode_singlethread(compiler_metadata& metadata, std::vector<source>& results);
+		static std::size_t first_undecoded(const std::vector<source>& sources) noexcept;
 		static bool decode_source(source& source, compiler_metadata& metadata);
+		static bool decode_source(source& source, compiler_metadata& metadata, raw_input&& input);
+		static raw_input read_source(const std::string& path, bool map_input);
 
 	private:
-		static bool decode_utf16_(const endian encoding_endian, const std::fpos_t length, const encoding detected_encoding,
-								  std::ifstream& stream, source& source, compiler_metadata& metadata);
-		static bool decode_utf32_(const endian encoding_endian, const std::fpos_t length, const encoding detected_encoding,
-								  std::ifstream& stream, source& source, compiler_metadata& metadata);
+		static bool read_file_(const std::string& path, std::string& buffer);
+		static bool decode_utf16_(const endian encoding_endian, const std::string_view& bytes, const encoding detected_encoding,
+								  source& source, compiler_metadata& metadata);
+		static bool decode_utf32_(const endian encoding_endian, const std::string_view& bytes, const encoding detected_encoding,
+								  source& source, compiler_metadata& metadata);
+	};
+
+	// Decodes a mapped input a chunk at a time into the codes of a source, and indexes the lines each chunk completes. UTF-8
+	// inputs are validated in place, so the codes of the source are the mapping itself; other encodings are transcoded into
+	// a buffer reserved for the whole input, so the codes never move while they are read. The mapped pages the stream has
+	// moved past are given back, so of a UTF-8 input only the pending line stays resident.
+	class decoding_stream final
+	{
+	public:
+		decoding_stream(source& source, compiler_metadata& metadata, std::size_t chunk_size);
+		decoding_stream(const decoding_stream& stream) = delete;
+		decoding_stream(decoding_stream&& stream) noexcept = delete;
+		~decoding_stream() = default;
+
+	public:
+		decoding_stream& operator=(const decoding_stream& stream) = delete;
+		decoding_stream& operator=(decoding_stream&& stream) noexcept = delete;
+		bool operator==(const decoding_stream& stream) const = delete;
+		bool operator!=(const decoding_stream& stream) const = delete;
+
+	public:
+		// Decodes the next chunk. The lines it completes are appended to the lines of the source, and the last line is
+		// appended once the input ends, when the source is published as decoded.
+		bool read();
+		bool eof() const noexcept;
+		// Inputs that can't be mapped aren't streamed, and are left to decoder::decode_source.
+		bool is_open() const noexcept;
+
+	private:
+		bool open_();
+		bool decode_(const std::string_view& bytes);
+
+	private:
+		source& source_;
+		compiler_metadata& metadata_;
+		mapped_file input_;
+		std::string_view bytes_;
+		std::size_t chunk_size_;
+		std::size_t read_ = 0;
+		encoding encoding_ = encoding::none;
+		std::size_t line_begin_ = 0;
+		std::size_t scanned_ = 0;
+		bool opened_ = false;
+		bool eof_ = false;
 	};
 }
 
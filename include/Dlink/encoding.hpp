@@ -1,6 +1,11 @@
 #ifndef DLINK_HEADER_ENCODING_HPP
 #define DLINK_HEADER_ENCODING_HPP
 
+#include <Dlink/system.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <istream>
 #include <map>
 #include <string>
@@ -23,9 +28,20 @@ namespace dlink
 
 	std::string to_string(dlink::encoding encoding);
 	encoding detect_encoding(std::istream& stream);
+	encoding detect_encoding(const std::string_view& bytes, std::size_t& bom_size) noexcept;
 
 	int get_character_length(char first_byte);
 
+	struct utf8_validation_result final
+	{
+		bool valid = false;
+		bool ascii = false;
+	};
+
+	utf8_validation_result validate_utf8(const std::string_view& string) noexcept;
+	bool utf16_to_utf8(const std::string_view& bytes, endian byte_order, std::string& output);
+	bool utf32_to_utf8(const std::string_view& bytes, endian byte_order, std::string& output);
+
 	enum class eol
 	{
 		lf,				// Line Feed,			0x0A
@@ -47,7 +63,6 @@ namespace dlink
 
 	std::string_view get_eol_character(dlink::eol eol);
 	std::string to_string(dlink::eol eol);
-	bool is_eol(std::istream& stream, int& char_size);
 
 	enum class whitespace
 	{
@@ -87,13 +102,151 @@ namespace dlink
 
 	std::string_view get_whitespace_character(dlink::whitespace whitespace);
 	std::string to_string(dlink::whitespace whitespace);
-	bool is_whitespace(std::istream& stream);
-	bool is_whitespace(std::istream& stream, char& output);
-	bool is_whitespace(std::istream& stream, char& output, whitespace& type);
 	std::pair<std::string, std::vector<std::pair<std::size_t, std::size_t>>> replace_with_space(const std::string_view& string);
 
 	bool isdigit(char c) noexcept;
 	bool isalpha(char c) noexcept;
 }
 
+namespace dlink
+{
+	namespace character_class
+	{
+		constexpr std::uint8_t whitespace = 1 << 0;		// Single-byte whitespace
+		constexpr std::uint8_t eol = 1 << 1;			// Single-byte EOL
+		constexpr std::uint8_t special = 1 << 2;		// Special character of the lexer
+		constexpr std::uint8_t unicode = 1 << 3;		// First byte of a multi-byte whitespace or EOL
+		constexpr std::uint8_t length_shift = 4;		// Bits 4-5 hold the length of the sequence minus 1
+		constexpr std::uint8_t length_mask = 3 << length_shift;
+	}
+
+	namespace details
+	{
+		constexpr std::array<std::uint8_t, 256> make_character_classes() noexcept
+		{
+			std::array<std::uint8_t, 256> result{};
+
+			for (std::size_t i = 0; i < result.size(); ++i)
+			{
+				// Continuation bytes are classified as single bytes, so a scan never gets stuck on them.
+				const std::uint8_t length = i >= 0xF0 ? 3 : i >= 0xE0 ? 2 : i >= 0xC0 ? 1 : 0;
+				result[i] = static_cast<std::uint8_t>(length << character_class::length_shift);
+			}
+
+#ifdef DLINK_LEAN_AND_MEAN
+			for (unsigned char c : std::string_view("\x09\x0A\x0D\x20"))
+				result[c] |= character_class::whitespace;
+			for (unsigned char c : std::string_view("\x0A\x0D"))
+				result[c] |= character_class::eol;
+
+			result[0xE3] |= character_class::unicode;
+#else
+			for (unsigned char c : std::string_view("\x09\x0A\x0B\x0C\x0D\x20"))
+				result[c] |= character_class::whitespace;
+			for (unsigned char c : std::string_view("\x0A\x0B\x0C\x0D\x1E"))
+				result[c] |= character_class::eol;
+
+			for (unsigned char c : std::string_view("\xC2\xE1\xE2\xE3"))
+				result[c] |= character_class::unicode;
+#endif
+
+			for (unsigned char c : std::string_view("~`!@#$%^&*()-+=|\\{[}]:;\"'<,>.?/"))
+				result[c] |= character_class::special;
+
+			return result;
+		}
+	}
+
+	inline constexpr std::array<std::uint8_t, 256> character_classes = details::make_character_classes();
+
+	inline std::uint8_t classify(char c) noexcept
+	{
+		return character_classes[static_cast<unsigned char>(c)];
+	}
+	inline int get_character_length_unchecked(char first_byte) noexcept
+	{
+		return ((classify(first_byte) & character_class::length_mask) >> character_class::length_shift) + 1;
+	}
+
+	std::size_t match_unicode_whitespace(const char* current, const char* end, whitespace& type, bool& is_eol) noexcept;
+
+	// Both return the size of the sequence starting at 'current', or 0 if it isn't one.
+	// Like the rest of the compiler, match_eol treats a LF that follows a single-byte EOL as a part of it.
+	inline std::size_t match_whitespace(const char* current, const char* end, whitespace& type) noexcept
+	{
+		const std::uint8_t c_class = classify(*current);
+
+		if (c_class & character_class::whitespace)
+		{
+			switch (*current)
+			{
+			case '\x09':
+				type = whitespace::tab;
+				return 1;
+
+#ifndef DLINK_LEAN_AND_MEAN
+			case '\x0B':
+				type = whitespace::line_tabulation;
+				return 1;
+
+			case '\x0C':
+				type = whitespace::form_feed;
+				return 1;
+#endif
+
+			case '\x0D':
+				if (current + 1 != end && current[1] == '\x0A')
+				{
+					type = whitespace::carriage_return_line_feed;
+					return 2;
+				}
+
+				type = whitespace::carriage_return;
+				return 1;
+
+			case '\x20':
+				type = whitespace::space;
+				return 1;
+
+			default:
+				type = whitespace::line_feed;
+				return 1;
+			}
+		}
+		else if (c_class & character_class::unicode)
+		{
+			bool is_eol;
+			return match_unicode_whitespace(current, end, type, is_eol);
+		}
+
+		return 0;
+	}
+	inline std::size_t match_eol(const char* current, const char* end) noexcept
+	{
+		const std::uint8_t c_class = classify(*current);
+
+		if (c_class & character_class::eol)
+		{
+			return current + 1 != end && current[1] == '\x0A' ? 2 : 1;
+		}
+#ifndef DLINK_LEAN_AND_MEAN
+		else if (c_class & character_class::unicode)
+		{
+			whitespace type;
+			bool is_eol;
+
+			if (const std::size_t length = match_unicode_whitespace(current, end, type, is_eol); is_eol)
+				return length;
+		}
+#endif
+
+		return 0;
+	}
+
+	// Both return the length of the run starting at 'current'. A word run is made of ASCII letters, digits and '_',
+	// and a blank run of spaces and tabs; the lexer consumes such runs at once instead of a character at a time.
+	std::size_t match_word_run(const char* current, const char* end) noexcept;
+	std::size_t match_blank_run(const char* current, const char* end) noexcept;
+}
+
 #endif
\ No newline at end of file
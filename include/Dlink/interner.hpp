@@ -0,0 +1,103 @@
+#ifndef DLINK_HEADER_INTERNER_HPP
+#define DLINK_HEADER_INTERNER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#ifdef DLINK_MULTITHREADING
+#	include <mutex>
+#endif
+
+namespace dlink
+{
+	using symbol = std::uint32_t;
+	constexpr symbol invalid_symbol = static_cast<symbol>(-1);
+
+	struct interner_statistics
+	{
+		std::uint64_t symbols;
+		std::uint64_t lookups;
+		std::uint64_t hits;
+		std::uint64_t contentions;		// Inserts that had to wait for another thread holding the shard
+	};
+
+	// Maps strings to dense symbols shared by every source. Looking up a string that is already interned takes no lock;
+	// new strings are inserted under the lock of one of the shards, chosen by the hash of the string. Interned strings
+	// are copied, so symbols outlive the sources they came from.
+	class interner final
+	{
+	public:
+		interner();
+		interner(const interner& interner) = delete;
+		interner(interner&& interner) noexcept = delete;
+		~interner();
+
+	public:
+		interner& operator=(const interner& interner) = delete;
+		interner& operator=(interner&& interner) noexcept = delete;
+		bool operator==(const interner& interner) const = delete;
+		bool operator!=(const interner& interner) const = delete;
+
+	public:
+		symbol intern(const std::string_view& string);
+		std::string_view string(symbol symbol) const noexcept;
+		std::size_t size() const noexcept;
+
+		// Lookups are counted by the callers, which add them in batches so the lookup path stays free of shared writes.
+		void add_lookups(std::size_t count) noexcept;
+		interner_statistics statistics() const noexcept;
+
+	private:
+		// A slot holds the low 32 bits of the hash above the symbol plus 1, so that 0 means an empty slot.
+		struct table_
+		{
+			explicit table_(std::size_t capacity);
+
+			std::size_t mask;
+			std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+		};
+
+		struct alignas(64) shard_
+		{
+			std::atomic<table_*> table{ nullptr };
+			std::size_t size = 0;
+			std::vector<std::unique_ptr<table_>> tables;		// The current one and the ones readers may still be probing
+			std::vector<std::unique_ptr<char[]>> blocks;
+			std::size_t block_used = 0;
+			std::size_t block_size = 0;
+			std::atomic<std::uint64_t> contentions{ 0 };
+
+#ifdef DLINK_MULTITHREADING
+			std::mutex mutex;
+#endif
+		};
+
+	private:
+		symbol find_(const table_& table, std::uint64_t hash, const std::string_view& string) const noexcept;
+		symbol insert_(shard_& shard, std::uint64_t hash, const std::string_view& string);
+		std::string_view store_(shard_& shard, const std::string_view& string);
+		void publish_(symbol symbol, const std::string_view& string);
+
+	private:
+#ifdef DLINK_MULTITHREADING
+		static constexpr std::size_t shard_bits_ = 6;
+#else
+		static constexpr std::size_t shard_bits_ = 0;
+#endif
+		// Symbols are stored in segments that double in size, so a segment never moves once readers can see it.
+		static constexpr std::size_t first_segment_bits_ = 10;
+		static constexpr std::size_t segment_count_ = 32 - first_segment_bits_ + 1;
+
+		std::array<shard_, std::size_t(1) << shard_bits_> shards_;
+		std::array<std::atomic<std::string_view*>, segment_count_> segments_;
+		std::atomic<symbol> next_symbol_{ 0 };
+		std::atomic<std::uint64_t> lookups_{ 0 };
+	};
+}
+
+#endif
\ No newline at end of file
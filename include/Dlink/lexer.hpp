@@ -2,29 +2,133 @@
 #define DLINK_HEADER_LEXER_HPP
 
 #include <Dlink/compiler_metadata.hpp>
+#include <Dlink/message.hpp>
+#include <Dlink/number.hpp>
 #include <Dlink/source.hpp>
 #include <Dlink/token.hpp>
+#include <Dlink/token_buffer.hpp>
 
+#include <cstddef>
 #include <istream>
-#include <map>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace dlink
 {
-	extern const std::map<std::string_view, token_type> keywords;
+#define MAP_KEYWORD(keyword) MAP_KEYWORD_INTERNAL(keyword, keyword_) 
+#define MAP_KEYWORD_INTERNAL(keyword, dummy) std::pair<std::string_view, token_type>(#keyword , token_type:: dummy##keyword)
+	// The table find_keyword looks words up in is built from this list at compile time.
+	inline constexpr std::pair<std::string_view, token_type> keywords[] =
+	{
+		MAP_KEYWORD(auto),
+		MAP_KEYWORD(void),
+		MAP_KEYWORD(bool),
+		MAP_KEYWORD(char),
+		MAP_KEYWORD(char16),
+		MAP_KEYWORD(char32),
+
+		MAP_KEYWORD(i8),
+		MAP_KEYWORD(i16),
+		MAP_KEYWORD(i32),
+		MAP_KEYWORD(i64),
+		MAP_KEYWORD(u8),
+		MAP_KEYWORD(u16),
+		MAP_KEYWORD(u32),
+		MAP_KEYWORD(u64),
+
+		MAP_KEYWORD(let),
+		MAP_KEYWORD(immut),
+		MAP_KEYWORD(mut),
+		MAP_KEYWORD(const),
+
+		MAP_KEYWORD(func),
+		MAP_KEYWORD(class),
+		MAP_KEYWORD(union),
+		MAP_KEYWORD(module),
+		MAP_KEYWORD(domain),
+		MAP_KEYWORD(inline),
+		MAP_KEYWORD(enum),
+		MAP_KEYWORD(public),
+		MAP_KEYWORD(internal),
+		MAP_KEYWORD(protected),
+		MAP_KEYWORD(private),
+		MAP_KEYWORD(use),
+		MAP_KEYWORD(as),
+		MAP_KEYWORD(default),
+		MAP_KEYWORD(macro),
+		MAP_KEYWORD(panic),
+
+		MAP_KEYWORD(for),
+		MAP_KEYWORD(do),
+		MAP_KEYWORD(while),
+		MAP_KEYWORD(match),
+		MAP_KEYWORD(if),
+		MAP_KEYWORD(else),
+		MAP_KEYWORD(goto),
+		MAP_KEYWORD(break),
+		MAP_KEYWORD(continue),
+		MAP_KEYWORD(return),
+
+		MAP_KEYWORD(extern),
+		MAP_KEYWORD(template),
+		MAP_KEYWORD(type),
+		MAP_KEYWORD(concept),
+		MAP_KEYWORD(unsafe),
+
+		MAP_KEYWORD(virtual),
+		MAP_KEYWORD(abstract),
+		MAP_KEYWORD(open),
+		MAP_KEYWORD(this),
+		MAP_KEYWORD(super),
+		MAP_KEYWORD(static),
+
+		MAP_KEYWORD(async),
+		MAP_KEYWORD(await),
+
+		MAP_KEYWORD(bit),
+		MAP_KEYWORD(new),
+		MAP_KEYWORD(delete),
+		MAP_KEYWORD(nullptr),
+
+		MAP_KEYWORD(static_cast),
+		MAP_KEYWORD(dynamic_cast),
+		MAP_KEYWORD(const_cast),
+		MAP_KEYWORD(reinterpret_cast),
+		MAP_KEYWORD(is),
+		MAP_KEYWORD(typeid),
+
+		MAP_KEYWORD(static_assert),
+
+		MAP_KEYWORD(true),
+		MAP_KEYWORD(false),
+	};
+#undef MAP_KEYWORD
+#undef MAP_KEYWORD_INTERNAL
+
+	token_type find_keyword(const std::string_view& string) noexcept;
 
 	class lexer final
 	{
+		friend class token_cursor;
+
 	private:
 		struct internal_lexing_data_
 		{
-			dlink::source& source;
-			compiler_metadata& metadata;
+			const dlink::source& source;
+			dlink::messages& messages;
 			std::vector<token>& tokens;
 			token& token;
 			std::size_t& token_index;
 		};
+		struct line_lexing_state_
+		{
+			bool ok = true;
+			bool multiline_comment = false;
+			std::size_t multiline_comment_line = 0, multiline_comment_col = 0;
+			std::string_view multiline_comment_line_data;
+			std::vector<std::size_t> comment_lines;		// The lines lexed that began inside a multiline comment
+		};
 
 	public:
 		lexer() = delete;
@@ -42,13 +146,34 @@ namespace dlink
 		static bool lex(compiler_metadata& metadata, std::vector<source>& sources);
 		static bool lex_singlethread(compiler_metadata& metadata, std::vector<source>& sources);
 		static bool lex_source(source& source, compiler_metadata& metadata);
+		static bool lex_fused(compiler_metadata& metadata, std::vector<source>& sources);
+		static bool lex_fused_singlethread(compiler_metadata& metadata, std::vector<source>& sources);
+		static bool lex_source_fused(source& source, compiler_metadata& metadata);
+		// Decodes, preprocesses and lexes a source a chunk at a time, so that only the lines of a chunk are read at once.
+		static bool lex_source_streaming(source& source, compiler_metadata& metadata, std::size_t chunk_size);
+		static bool relex_source(source& source, compiler_metadata& metadata, const source_edit& edit);
 
 		static bool check_invalid_identifier(const std::string_view& string);
 
 	private:
-		static bool lex_preprocess_(source& source, compiler_metadata& metadata, std::vector<token>& tokens);
+		static bool check_size_(const source& source, dlink::messages& messages, std::size_t size);
+		static bool lex_preprocess_(const source& source, dlink::messages& messages, std::vector<token>& tokens,
+									std::vector<std::size_t>& comment_lines);
+#ifdef DLINK_MULTITHREADING
+		static bool lex_preprocess_parallel_(const source& source, compiler_metadata& metadata, std::vector<token>& tokens,
+											 std::vector<std::size_t>& comment_lines, std::size_t chunk_size);
+#endif
+		static void lex_line_(const source& source, dlink::messages& messages, const std::string_view& current_line,
+							  std::size_t line, std::size_t line_offset, line_lexing_state_& state, std::vector<token>& tokens);
+		static bool lex_end_(const source& source, dlink::messages& messages, line_lexing_state_& state);
+		static bool lex_tokens_(const source& source, compiler_metadata& metadata, std::vector<token>& tokens, token_buffer& buffer);
+		static bool push_token_(const source& source, compiler_metadata& metadata, dlink::messages& messages, const token& token,
+								token_buffer& buffer, bool& ok);
+		static bool lex_token_(const source& source, dlink::messages& messages, std::vector<token>& tokens, std::size_t& i,
+							   token* prev_token, bool& ok);
 		static bool lex_number_(internal_lexing_data_ data, bool cannot_sn = false);
 		static bool lex_number_with_base_(internal_lexing_data_ data, int base);
+		static bool evaluate_number_(const source& source, dlink::messages& messages, const token& token, number_value& value, bool& ok);
 	};
 }
 
@@ -0,0 +1,51 @@
+#ifndef DLINK_HEADER_LINE_INDEX_HPP
+#define DLINK_HEADER_LINE_INDEX_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace dlink
+{
+	class line_index final
+	{
+	public:
+		line_index() noexcept = default;
+		explicit line_index(const std::string_view& codes);
+		line_index(const line_index& index) = default;
+		line_index(line_index&& index) noexcept = default;
+		~line_index() = default;
+
+	public:
+		line_index& operator=(const line_index& index) = default;
+		line_index& operator=(line_index&& index) noexcept = default;
+		bool operator==(const line_index& index) const = delete;
+		bool operator!=(const line_index& index) const = delete;
+
+	public:
+		// Indexes the lines in [begin, end) of 'codes'. 'begin' must be the beginning of a line, and a line that
+		// isn't terminated by an EOL before 'end' is indexed as if 'end' were the end of the codes.
+		void append(const std::string_view& codes, std::size_t begin, std::size_t end);
+		// Like append, for codes that more codes may still follow: only the lines whose EOL is complete before 'end' are
+		// indexed, and the beginning of the first line left out is returned. 'scanned' is where the previous call stopped
+		// looking for EOLs, and is moved to where the next one begins, so every byte is looked at about once.
+		std::size_t append_partial(const std::string_view& codes, std::size_t begin, std::size_t& scanned, std::size_t end);
+		void clear() noexcept;
+		bool empty() const noexcept;
+		std::size_t count() const noexcept;
+
+	public:
+		// Lines are 1-based, columns are 0-based.
+		std::size_t line(std::size_t offset) const noexcept;
+		std::size_t col(std::size_t offset) const noexcept;
+		std::size_t line_begin(std::size_t line) const noexcept;
+		std::size_t line_end(std::size_t line) const noexcept;
+		std::string_view line_data(const std::string_view& codes, std::size_t line) const noexcept;
+
+	private:
+		std::vector<std::size_t> begins_;
+		std::vector<std::size_t> ends_;
+	};
+}
+
+#endif
\ No newline at end of file
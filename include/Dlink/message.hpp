@@ -1,7 +1,7 @@
 #ifndef DLINK_HEADER_MESSAGE_HPP
 #define DLINK_HEADER_MESSAGE_HPP
 
-#include <Dlink/vector.hpp>
+#include <Dlink/concurrent_vector.hpp>
 
 #include <cstddef>
 #include <cstdint>
@@ -122,7 +122,8 @@ namespace dlink
 		virtual message_type type() const noexcept override;
 	};
 
-	class messages final : public vector<message_ptr>
+	// Stages push messages to the same list concurrently, so it never locks.
+	class messages final : public concurrent_vector<message_ptr>
 	{
 	public:
 		bool has_error() const;
@@ -0,0 +1,62 @@
+#ifndef DLINK_HEADER_NUMBER_HPP
+#define DLINK_HEADER_NUMBER_HPP
+
+#include <Dlink/token.hpp>
+
+#include <cstdint>
+#include <string_view>
+
+namespace dlink
+{
+	enum class number_kind
+	{
+		integer,
+		floating,
+	};
+
+	// The value of a numeric literal. Integers are unsigned and up to 128 bits wide; literals with a fraction or an
+	// exponent are doubles.
+	class number_value final
+	{
+	public:
+		number_value() noexcept = default;
+		number_value(std::uint64_t integer_low, std::uint64_t integer_high) noexcept;
+		explicit number_value(double floating) noexcept;
+		number_value(const number_value& value) noexcept = default;
+		~number_value() = default;
+
+	public:
+		number_value& operator=(const number_value& value) noexcept = default;
+		bool operator==(const number_value& value) const = delete;
+		bool operator!=(const number_value& value) const = delete;
+
+	public:
+		number_kind kind() const noexcept;
+		bool fits_in_64() const noexcept;
+		std::uint64_t integer() const noexcept;
+		std::uint64_t integer_high() const noexcept;
+		double floating() const noexcept;
+
+	private:
+		number_kind kind_ = number_kind::integer;
+		std::uint64_t low_ = 0;		// The bits of the double when the kind is floating
+		std::uint64_t high_ = 0;
+	};
+
+	enum class number_evaluation
+	{
+		ok,
+		overflow,		// The integer needs more than 128 bits
+		invalid,		// The literal isn't made of digits the parser understands
+	};
+
+	// Underscores between digits are skipped by all of them.
+	number_evaluation parse_integer(const std::string_view& digits, int base, number_value& value) noexcept;
+	// Digits with an optional fraction and exponent, rounded to the nearest double.
+	number_evaluation parse_floating(const std::string_view& digits, number_value& value);
+	// Evaluates a token the lexer classified as integer_bin, integer_oct, integer_dec, integer_hex or decimal.
+	number_evaluation evaluate_number(const token& token, number_value& value);
+	bool is_number(token_type type) noexcept;
+}
+
+#endif
\ No newline at end of file
@@ -2,9 +2,11 @@
 #define DLINK_HEADER_PREPROCESSOR_HPP
 
 #include <Dlink/compiler_metadata.hpp>
+#include <Dlink/message.hpp>
 #include <Dlink/source.hpp>
 
 #include <cstddef>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -12,6 +14,8 @@ namespace dlink
 {
 	class preprocessor final
 	{
+		friend class lexer;
+
 	public:
 		preprocessor() = delete;
 		preprocessor(const preprocessor& preprocessor) = delete;
@@ -28,6 +32,13 @@ namespace dlink
 		static bool preprocess(compiler_metadata& metadata, std::vector<source>& sources);
 		static bool preprocess_singlethread(compiler_metadata& metadata, std::vector<source>& sources);
 		static bool preprocess_source(source& source, compiler_metadata& metadata);
+		static bool preprocess_source_streaming(source& source, compiler_metadata& metadata, std::size_t chunk_size);
+
+	private:
+		static bool preprocess_lines_(const source& source, dlink::messages& messages, const std::string_view& codes,
+									  const line_index& lines, std::size_t first_line, bool& ok, std::vector<preprocessed_line>& result);
+		static bool preprocess_line_(const source& source, dlink::messages& messages, const std::string_view& current_line,
+									 std::size_t line, bool& ok);
 	};
 
 	class macro_base
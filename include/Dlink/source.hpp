@@ -2,17 +2,18 @@
 #define DLINK_HEADER_SOURCE_HPP
 
 #include <Dlink/compiler_metadata.hpp>
+#include <Dlink/line_index.hpp>
+#include <Dlink/system.hpp>
 #include <Dlink/token.hpp>
+#include <Dlink/token_buffer.hpp>
 #include <Dlink/extlib/json.hpp>
 
+#include <atomic>
+#include <cstddef>
 #include <string>
 #include <string_view>
 #include <vector>
 
-#ifdef DLINK_MULTITHREADING
-#	include <mutex>
-#endif
-
 namespace dlink
 {
 	enum class source_state
@@ -24,14 +25,42 @@ namespace dlink
 		lexed,
 	};
 
+	struct raw_input final
+	{
+		mapped_file mapping;
+		std::string buffer;
+		std::string_view borrowed;
+		bool loaded = false;
+	};
+
+	struct preprocessed_line final
+	{
+		std::string_view data;	// A view of the codes of the source
+		std::size_t line = 0;	// The line in the codes the data came from
+	};
+
+	// Replaces 'length' bytes of the codes at 'offset' with 'replacement', which must be UTF-8.
+	struct source_edit final
+	{
+		std::size_t offset = 0;
+		std::size_t length = 0;
+		std::string_view replacement;
+	};
+
+	// A stage fills in its buffers and only then publishes them by advancing the state with release semantics. Readers
+	// check the state with acquire semantics first, and a published buffer isn't changed again until the source is
+	// relexed or assigned, so reading it needs no lock.
 	class source final
 	{
 		friend class decoder;
+		friend class decoding_stream;
 		friend class preprocessor;
 		friend class lexer;
 
 	public:
 		source(const std::string_view& path);
+		source(const std::string_view& path, std::string&& codes);
+		source(const std::string_view& path, const std::string_view& codes);
 		source(const source& source) = delete;
 		source(source&& source) noexcept;
 		~source() = default;
@@ -48,39 +77,49 @@ namespace dlink
 		bool decode(compiler_metadata& metadata);
 		bool preprocess(compiler_metadata& metadata);
 		bool lex(compiler_metadata& metadata);
+		bool lex_fused(compiler_metadata& metadata);
+		// Applies an edit to a lexed source, relexing only the lines around it.
+		bool relex(compiler_metadata& metadata, const source_edit& edit);
 
 		bool compile_until_preprocessing(compiler_metadata& metadata);
 		bool compile_until_lexing(compiler_metadata& metadata);
+		bool compile_until_lexing_fused(compiler_metadata& metadata);
 
 		nlohmann::json dump() const;
 		nlohmann::json dump_tokens() const;
 
 	public:
-		const std::string& codes() const noexcept;
-		const std::vector<std::string>& preprocessed_codes() const noexcept;
+		std::string_view codes() const noexcept;
+		const dlink::line_index& lines() const noexcept;
+		const std::vector<preprocessed_line>& preprocessed_codes() const noexcept;
 		const std::string& path() const noexcept;
-		const dlink::tokens& tokens() const noexcept;
+		const dlink::token_buffer& tokens() const noexcept;
 
 		source_state state() const noexcept;
 
 	private:
-		void codes(std::string&& new_codes);
-		void preprocessed_codes(std::vector<std::string>&& new_preprocessed_codes);
-		void tokens(dlink::tokens&& new_tokens);
+		void codes(std::string&& new_codes, std::size_t offset = 0);
+		void codes(mapped_file&& new_codes, std::size_t offset = 0);
+		void codes(const std::string_view& new_codes, std::size_t offset = 0);
+		void codes(std::string&& new_codes, dlink::line_index&& new_lines);
+		void preprocessed_codes(std::vector<preprocessed_line>&& new_preprocessed_codes);
+		void tokens(dlink::token_buffer&& new_tokens);
+		void publish_(source_state new_state) noexcept;
+		// Points the views into the codes at the codes of this source, which moved from 'old_codes'.
+		void rebase_(const std::string_view& old_codes) noexcept;
 
 	private:
 		std::string codes_;
-		std::vector<std::string> preprocessed_codes_;
+		mapped_file codes_mapping_;
+		std::string_view codes_borrowed_;
+		std::size_t codes_offset_ = 0;
+		raw_input input_;
+		dlink::line_index lines_;
+		std::vector<preprocessed_line> preprocessed_codes_;
 		std::string path_;
-		dlink::tokens tokens_;
-
-		source_state state_;
+		dlink::token_buffer tokens_;
 
-#ifdef DLINK_MULTITHREADING
-		mutable std::mutex codes_mutex_;
-		mutable std::mutex preprocessed_codes_mutex_;
-		mutable std::mutex tokens_mutex_;
-#endif
+		std::atomic<source_state> state_;
 	};
 
 	using sources = std::vector<source>;
@@ -1,6 +1,24 @@
 #ifndef DLINK_HEADER_SYSTEM_HPP
 #define DLINK_HEADER_SYSTEM_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#	define DLINK_X86
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#	define DLINK_TARGET(isa) __attribute__((target(isa)))
+#else
+#	define DLINK_TARGET(isa)
+#endif
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
 namespace dlink
 {
 	enum class endian
@@ -11,6 +29,68 @@ namespace dlink
 	};
 
 	endian get_endian();
+
+	enum class instruction_set
+	{
+		none,
+		sse42,
+		avx2,
+		avx512,
+	};
+
+	instruction_set get_instruction_set() noexcept;
+
+	// Returns the number of bits needed to represent 'value', which is 0 for 0.
+	inline int bit_width(std::uint64_t value) noexcept
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		return _BitScanReverse64(&index, value) ? static_cast<int>(index) + 1 : 0;
+#elif defined(_MSC_VER)
+		unsigned long index;
+
+		if (_BitScanReverse(&index, static_cast<unsigned long>(value >> 32))) return static_cast<int>(index) + 33;
+		return _BitScanReverse(&index, static_cast<unsigned long>(value)) ? static_cast<int>(index) + 1 : 0;
+#else
+		return value ? 64 - __builtin_clzll(value) : 0;
+#endif
+	}
+
+	// Returns the size of the file at 'path' without opening it, or 0 if it can't be found out.
+	std::uint64_t get_file_size(const std::string& path) noexcept;
+
+	class mapped_file final
+	{
+	public:
+		mapped_file() noexcept = default;
+		mapped_file(const mapped_file& file) = delete;
+		mapped_file(mapped_file&& file) noexcept;
+		~mapped_file();
+
+	public:
+		mapped_file& operator=(const mapped_file& file) = delete;
+		mapped_file& operator=(mapped_file&& file) noexcept;
+		bool operator==(const mapped_file& file) const = delete;
+		bool operator!=(const mapped_file& file) const = delete;
+
+	public:
+		bool open(const std::string& path);
+		void close() noexcept;
+		bool is_open() const noexcept;
+		void prefetch() const noexcept;
+		// Gives back the memory of the whole pages in the first 'length' bytes. They stay mapped, and are read from the file
+		// again if they're accessed later.
+		void release(std::size_t length) noexcept;
+
+	public:
+		const char* data() const noexcept;
+		std::size_t size() const noexcept;
+
+	private:
+		const char* data_ = nullptr;
+		std::size_t size_ = 0;
+		std::size_t released_ = 0;
+	};
 }
 
 #endif
\ No newline at end of file
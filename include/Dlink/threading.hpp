@@ -2,9 +2,20 @@
 #define DLINK_HEADER_THREADING_HPP
 
 #include <Dlink/compiler_metadata.hpp>
+#include <Dlink/decoder.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
-#include <future>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -16,40 +27,282 @@ namespace dlink
 		std::size_t average = 0;
 		std::size_t remainder = 0;
 		std::size_t count_of_threads = 0;
+
+		// Filled in when the sizes of the jobs are known. The jobs are ordered largest first so that the threads start on
+		// the ones that take longest, and the small ones at the end are batched into tasks of their own.
+		std::vector<std::size_t> order;
+		std::vector<std::size_t> task_ends;		// Where each task ends in order
+		std::uint64_t size = 0;
+		std::uint64_t predicted_size = 0;		// The bytes the busiest thread gets when the tasks are handed out in order
 	};
 
 	threading_info get_threading_info(const compiler_metadata& metadata);
+	threading_info get_threading_info(const compiler_metadata& metadata, std::size_t count_of_jobs);
+	threading_info get_threading_info(const compiler_metadata& metadata, const std::vector<std::uint64_t>& sizes);
+	// The jobs are the sources from 'offset', sized by their codes or, before they are decoded, by their files.
+	threading_info get_threading_info(const compiler_metadata& metadata, const std::vector<source>& sources, std::size_t offset = 0);
+	void record_schedule(compiler_metadata& metadata, const char* stage, const threading_info& info,
+						 std::chrono::steady_clock::duration actual_makespan, std::chrono::steady_clock::duration busy_time);
+
+	// A pool of workers shared by the whole process, each with its own deque of tasks. A worker takes the newest task
+	// from its own deque and steals the oldest one from the others when it runs dry, so a thread that is done with its
+	// files helps with the rest instead of going idle. The thread that runs a batch takes part in it until the batch is
+	// done, so a task can run a nested batch of its own without tying up a worker. A batch runs on no more threads than
+	// it asks for: its tasks are dealt to that many queues and only the workers of those queues take them, so a pool
+	// grown by one pipeline doesn't widen the batches of another.
+	class thread_pool final
+	{
+	public:
+		explicit thread_pool(std::size_t count_of_workers);
+		thread_pool(const thread_pool& pool) = delete;
+		thread_pool(thread_pool&& pool) noexcept = delete;
+		~thread_pool();
+
+	public:
+		thread_pool& operator=(const thread_pool& pool) = delete;
+		thread_pool& operator=(thread_pool&& pool) noexcept = delete;
+		bool operator==(const thread_pool& pool) const = delete;
+		bool operator!=(const thread_pool& pool) const = delete;
+
+	public:
+		// Calls function(i) as a task of its own for every i in [begin, end) on at most count_of_threads threads including
+		// the caller and returns whether all of them returned true. The first exception thrown by a task is rethrown once
+		// every task has finished.
+		template<typename Func_>
+		bool run(Func_&& function, std::size_t begin, std::size_t end, std::size_t count_of_threads)
+		{
+			batch_ batch;
+			bind_(batch, function);
+
+			return run_(batch, begin, end, count_of_threads);
+		}
+		// Runs a batch of count_of_tasks tasks of which only the ones in ready_tasks can start right away. The tasks of the
+		// batch queue the others by calling ready, and the batch is done once every task has been queued and has run.
+		template<typename Func_>
+		bool run(Func_&& function, std::size_t count_of_tasks, const std::vector<std::size_t>& ready_tasks, std::size_t count_of_threads)
+		{
+			batch_ batch;
+			bind_(batch, function);
+
+			return run_(batch, count_of_tasks, ready_tasks, count_of_threads);
+		}
+		// Queues a task of the batch that the task running on the calling thread belongs to.
+		void ready(std::size_t index);
+		// Workers are never stopped before the pool is destroyed, so the pool only grows.
+		void reserve(std::size_t count_of_workers);
+		std::size_t count_of_workers() const noexcept;
+
+	public:
+		// Returns the pool of the process, grown so that count_of_threads threads including the caller can run a batch.
+		static thread_pool& shared(std::size_t count_of_threads);
+
+	private:
+		struct batch_
+		{
+			bool (*invoke)(void* function, std::size_t index) = nullptr;
+			void* function = nullptr;
+			std::size_t count_of_threads = 1;		// Only the threads whose queues come before it take the tasks
+			std::atomic<std::size_t> pending{ 0 };
+			std::atomic<bool> result{ true };
+			std::atomic<bool> failed{ false };
+			std::exception_ptr exception;
+		};
+		struct task_
+		{
+			batch_* batch;
+			std::size_t index;
+		};
+		struct alignas(64) queue_
+		{
+			std::mutex mutex;
+			std::deque<task_> tasks;
+		};
+
+	private:
+		template<typename Func_>
+		static void bind_(batch_& batch, Func_& function) noexcept
+		{
+			using function_type = std::remove_reference_t<Func_>;
+
+			batch.function = const_cast<void*>(static_cast<const void*>(std::addressof(function)));
+			batch.invoke = [](void* function, std::size_t index) -> bool
+			{
+				return (*static_cast<function_type*>(function))(index);
+			};
+		}
+
+		bool run_(batch_& batch, std::size_t begin, std::size_t end, std::size_t count_of_threads);
+		bool run_(batch_& batch, std::size_t count_of_tasks, const std::vector<std::size_t>& ready_tasks, std::size_t count_of_threads);
+		// Queues indices[i], or begin + i without indices, for every i in [0, count).
+		void push_(batch_& batch, std::size_t begin, std::size_t count, const std::size_t* indices);
+		bool wait_(batch_& batch);
+		void work_(std::size_t index);
+		// Takes a task from the queue at 'index' or steals one, skipping the tasks of batches that the threads with
+		// queues from 'rank' on don't run.
+		bool take_(std::size_t index, std::size_t rank, task_& task);
+		bool queued_for_(std::size_t rank) const noexcept;
+		void execute_(const task_& task);
+
+	private:
+		// The first queue belongs to the threads that aren't workers of the pool, and the others to one worker each.
+		std::unique_ptr<queue_[]> queues_;
+		std::atomic<std::size_t> count_of_queues_{ 1 };
+		// The count of queued tasks of the batches that run on i + 1 threads is at i.
+		std::unique_ptr<std::atomic<std::size_t>[]> queued_;
+		bool stopped_ = false;
+
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		std::vector<std::thread> workers_;
+
+		static thread_local batch_* current_batch_;
+
+	public:
+		static constexpr std::size_t max_count_of_workers = compiler_options::max_count_of_threads - 1;
+	};
+
+	// Tasks that depend on others and start as soon as the ones they depend on are done. A task that depends on one
+	// that failed isn't called and fails too, the way a source that failed a stage never goes through the next one.
+	class task_graph final
+	{
+	public:
+		task_graph() = default;
+		task_graph(const task_graph& graph) = delete;
+		task_graph(task_graph&& graph) noexcept = delete;
+		~task_graph() = default;
+
+	public:
+		task_graph& operator=(const task_graph& graph) = delete;
+		task_graph& operator=(task_graph&& graph) noexcept = delete;
+		bool operator==(const task_graph& graph) const = delete;
+		bool operator!=(const task_graph& graph) const = delete;
+
+	public:
+		std::size_t add(std::function<bool()> function);
+		// Makes 'task' wait for 'dependency', which has to be added before it so that the graph can't have a cycle.
+		void depend(std::size_t task, std::size_t dependency);
+		// Returns whether every task was called and returned true. Tasks that are ready at the same time start in the
+		// order they were added.
+		bool run(thread_pool& pool, std::size_t count_of_threads);
+		std::size_t size() const noexcept;
+
+	private:
+		struct node_
+		{
+			std::function<bool()> function;
+			std::vector<std::size_t> dependents;
+			std::size_t count_of_dependencies = 0;
+			std::atomic<std::size_t> remaining{ 0 };
+			std::atomic<bool> skipped{ false };
+		};
+
+	private:
+		void finish_(thread_pool& pool, node_& node, bool result);
+
+	private:
+		std::deque<node_> nodes_;
+	};
 
 	template<typename Func_>
 	bool parallel(Func_&& function, const threading_info& info, std::size_t offset = 0)
 	{
-		bool result = true;
+		if (info.count_of_threads == 0)
+			return true;
 
-		std::vector<std::future<bool>> futures;
+		thread_pool& pool = thread_pool::shared(info.count_of_threads);
 
-		for (std::size_t i = 0; i < info.count_of_threads - 1; ++i)
+		if (info.order.empty())
 		{
-			futures.push_back(
-				std::async(std::forward<Func_>(function),
-						   i * info.average + offset,
-						   (i + 1) * info.average + offset
-			));
+			const std::size_t end = info.count_of_threads * info.average + info.remainder + offset;
+
+			return pool.run([&function](std::size_t index) -> bool
+			{
+				return function(index, index + 1);
+			}, offset, end, info.count_of_threads);
 		}
 
-		futures.push_back(
-			std::async(std::forward<Func_>(function),
-					   (info.count_of_threads - 1) * info.average + offset,
-					   info.count_of_threads * info.average + info.remainder + offset
-		));
+		return pool.run([&function, &info, offset](std::size_t task) -> bool
+		{
+			bool result = true;
+
+			for (std::size_t i = task == 0 ? 0 : info.task_ends[task - 1]; i < info.task_ends[task]; ++i)
+			{
+				result = function(info.order[i] + offset, info.order[i] + offset + 1) && result;
+			}
 
-		for (auto& future : futures)
+			return result;
+		}, 0, info.task_ends.size(), info.count_of_threads);
+	}
+	// Also records how the stage was scheduled in the metadata.
+	template<typename Func_>
+	bool parallel(Func_&& function, const threading_info& info, compiler_metadata& metadata, const char* stage, std::size_t offset = 0)
+	{
+		using clock = std::chrono::steady_clock;
+
+		std::atomic<clock::rep> busy_time{ 0 };
+		const clock::time_point begin = clock::now();
+
+		const bool result = parallel([&function, &busy_time](std::size_t begin, std::size_t end) -> bool
 		{
-			future.wait();
-			result = result && future.get();
-		}
+			const clock::time_point task_begin = clock::now();
+			const bool result = function(begin, end);
+
+			busy_time.fetch_add((clock::now() - task_begin).count(), std::memory_order_relaxed);
+			return result;
+		}, info, offset);
 
+		record_schedule(metadata, stage, info, clock::now() - begin, clock::duration(busy_time.load(std::memory_order_relaxed)));
 		return result;
 	}
+	template<typename Func_>
+	bool parallel_for_each(Func_&& function, const threading_info& info, std::size_t offset = 0)
+	{
+		if (info.count_of_threads == 0)
+			return true;
+
+		const std::size_t end = info.count_of_threads * info.average + info.remainder + offset;
+
+		return thread_pool::shared(info.count_of_threads).run(function, offset, end, info.count_of_threads);
+	}
+
+	class read_ahead final
+	{
+	public:
+		read_ahead(const std::vector<std::string>& paths, bool map_input, std::size_t depth);
+		read_ahead(const read_ahead& reader) = delete;
+		read_ahead(read_ahead&& reader) noexcept = delete;
+		~read_ahead();
+
+	public:
+		read_ahead& operator=(const read_ahead& reader) = delete;
+		read_ahead& operator=(read_ahead&& reader) noexcept = delete;
+		bool operator==(const read_ahead& reader) const = delete;
+		bool operator!=(const read_ahead& reader) const = delete;
+
+	public:
+		raw_input take(std::size_t index);
+
+	private:
+		void read_();
+
+	private:
+		const std::vector<std::string>& paths_;
+		bool map_input_;
+		std::size_t depth_;
+
+		std::vector<raw_input> inputs_;
+		std::vector<bool> ready_;
+		std::size_t next_ = 0;
+		std::size_t taken_ = 0;
+		bool stopped_ = false;
+
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		std::vector<std::thread> readers_;
+
+	public:
+		static constexpr std::size_t max_count_of_readers = 2;
+	};
 }
 
 #endif
\ No newline at end of file
@@ -1,7 +1,7 @@
 #ifndef DLINK_HEADER_TOKEN_HPP
 #define DLINK_HEADER_TOKEN_HPP
 
-#include <Dlink/vector.hpp>
+#include <Dlink/line_index.hpp>
 #include <Dlink/extlib/json.hpp>
 
 #include <cstddef>
@@ -181,18 +181,21 @@ namespace dlink
 	std::string to_string(token_type type);
 
 	extern const std::vector<char> special_characters;
-	bool is_special_character(char character);
+	bool is_special_character(char character) noexcept;
 	bool is_valid_special_character(char character) noexcept;
 	token_type to_token_type(char valid_special_character) noexcept;
 	bool is_single_special_character(char valid_special_character) noexcept;
-	token_type complex_token_type(token_type type, char valid_special_character) noexcept;
+
+	constexpr std::size_t max_operator_length = 3;
+	// Finds the longest operator at the beginning of [begin, end). Returns its length, or 0 if there is none.
+	std::size_t match_operator(const char* begin, const char* end, token_type& type) noexcept;
 	
 	class token final
 	{
 	public:
 		token() = default;
-		token(const std::string_view& data, token_type type, std::size_t line, std::size_t col, const std::string_view& line_data);
-		token(const std::string_view& data, token_type type, std::size_t line, std::size_t col, const std::string_view& line_data,
+		token(const std::string_view& data, token_type type, std::size_t offset);
+		token(const std::string_view& data, token_type type, std::size_t offset,
 			const std::string_view& prefix_literal, const std::string_view& postfix_literal);
 		token(const token& token);
 		~token() = default;
@@ -206,35 +209,27 @@ namespace dlink
 		void clear() noexcept;
 		bool empty() const noexcept;
 
-		nlohmann::json dump() const;
+		nlohmann::json dump(const line_index& lines) const;
 
 	public:
-		std::size_t line() const noexcept;
-		void line(std::size_t new_line) noexcept;
-		std::size_t col() const noexcept;
-		void col(std::size_t new_col) noexcept;
+		std::size_t offset() const noexcept;
+		void offset(std::size_t new_offset) noexcept;
 		token_type type() const noexcept;
 		void type(token_type new_type) noexcept;
 		const std::string_view& data() const noexcept;
 		void data(const std::string_view& new_data) noexcept;
-		const std::string_view& line_data() const noexcept;
-		void line_data(const std::string_view& new_line_data) noexcept;
 		const std::string_view& prefix_literal() const noexcept;
 		void prefix_literal(const std::string_view& new_prefix_literal) noexcept;
 		const std::string_view& postfix_literal() const noexcept;
 		void postfix_literal(const std::string_view& new_postfix_literal) noexcept;
 
 	private:
-		std::size_t line_ = 0;
-		std::size_t col_ = 0;
+		std::size_t offset_ = 0;	// From the beginning of the codes; line_index gives its line and column
 		token_type type_ = token_type::none;
 		std::string_view data_;
-		std::string_view line_data_;
 		std::string_view prefix_literal_;
 		std::string_view postfix_literal_;
 	};
-
-	using tokens = vector<token>;
 }
 
 #endif
\ No newline at end of file
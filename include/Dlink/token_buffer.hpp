@@ -0,0 +1,166 @@
+#ifndef DLINK_HEADER_TOKEN_BUFFER_HPP
+#define DLINK_HEADER_TOKEN_BUFFER_HPP
+
+#include <Dlink/interner.hpp>
+#include <Dlink/line_index.hpp>
+#include <Dlink/number.hpp>
+#include <Dlink/token.hpp>
+#include <Dlink/extlib/json.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace dlink
+{
+	class token_buffer;
+
+	class token_view final
+	{
+	public:
+		token_view(const token_buffer& buffer, std::size_t index) noexcept;
+		token_view(const token_view& view) noexcept = default;
+		~token_view() = default;
+
+	public:
+		token_view& operator=(const token_view& view) noexcept = default;
+		bool operator==(const token_view& view) const = delete;
+		bool operator!=(const token_view& view) const = delete;
+
+	public:
+		bool empty() const noexcept;
+		token to_token() const;
+
+		nlohmann::json dump(const line_index& lines) const;
+
+	public:
+		std::size_t index() const noexcept;
+		std::size_t offset() const noexcept;
+		// The offset just past the token and its literals.
+		std::size_t end_offset() const noexcept;
+		token_type type() const noexcept;
+		std::string_view data() const noexcept;
+		std::string_view prefix_literal() const noexcept;
+		std::string_view postfix_literal() const noexcept;
+		// The value the lexer evaluated, or nullptr if the token isn't a numeric literal.
+		const number_value* number() const noexcept;
+		// The symbol the lexer interned, or invalid_symbol if the token isn't an identifier.
+		dlink::symbol symbol() const noexcept;
+
+	private:
+		const token_buffer* buffer_;
+		std::size_t index_;
+	};
+
+	class token_buffer final
+	{
+		friend class token_view;
+
+	public:
+		class const_iterator final
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = token_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = token_view;
+
+		public:
+			const_iterator(const token_buffer& buffer, std::size_t index) noexcept;
+
+		public:
+			token_view operator*() const noexcept;
+			const_iterator& operator++() noexcept;
+			const_iterator operator++(int) noexcept;
+			bool operator==(const const_iterator& iterator) const noexcept;
+			bool operator!=(const const_iterator& iterator) const noexcept;
+
+		private:
+			const token_buffer* buffer_;
+			std::size_t index_;
+		};
+
+	private:
+		// Only tokens with a literal, or whose data doesn't start at their location, have an entry. Entries are sorted by index,
+		// and so are the entries of the numeric literals and of the identifiers.
+		struct literal_entry_
+		{
+			std::uint32_t index;
+			std::uint32_t data_offset;
+			std::uint32_t prefix_offset, prefix_length;
+			std::uint32_t postfix_offset, postfix_length;
+		};
+		struct number_entry_
+		{
+			std::uint32_t index;
+			number_value value;
+		};
+		struct symbol_entry_
+		{
+			std::uint32_t index;
+			dlink::symbol symbol;
+		};
+
+	public:
+		token_buffer() noexcept = default;
+		token_buffer(const std::string_view& codes, const std::vector<token>& tokens);
+		token_buffer(const token_buffer& buffer) = default;
+		token_buffer(token_buffer&& buffer) noexcept = default;
+		~token_buffer() = default;
+
+	public:
+		token_buffer& operator=(const token_buffer& buffer) = default;
+		token_buffer& operator=(token_buffer&& buffer) noexcept = default;
+		token_view operator[](std::size_t index) const noexcept;
+		bool operator==(const token_buffer& buffer) const = delete;
+		bool operator!=(const token_buffer& buffer) const = delete;
+
+	public:
+		void clear() noexcept;
+		bool empty() const noexcept;
+		std::size_t size() const noexcept;
+		void reserve(std::size_t new_capacity);
+		void push_back(const token& token);
+		void push_back(const token& token, const number_value& value);
+		void push_back(const token& token, dlink::symbol symbol);
+		// Replaces the tokens in [begin, end) with the tokens of a buffer over the same codes, and moves the tokens after them
+		// by 'offset_delta' bytes. The codes aren't read, so they may have been edited since the tokens were stored.
+		void splice(std::size_t begin, std::size_t end, const token_buffer& buffer, std::ptrdiff_t offset_delta);
+		// Returns the index of the first token at or after 'offset'.
+		std::size_t index_at(std::size_t offset) const noexcept;
+
+		const_iterator begin() const noexcept;
+		const_iterator end() const noexcept;
+
+	public:
+		// Every token is a view of these codes; offsets are stored relative to them.
+		std::string_view codes() const noexcept;
+		void codes(const std::string_view& new_codes);
+
+		// The lines that begin inside a multiline comment, in order. They let the lexer resume at any line.
+		const std::vector<std::size_t>& comment_lines() const noexcept;
+		void comment_lines(std::vector<std::size_t>&& new_comment_lines) noexcept;
+		bool in_comment(std::size_t line) const noexcept;
+
+	private:
+		std::uint32_t to_offset_(const std::string_view& view) const noexcept;
+		const literal_entry_* find_literal_(std::size_t index) const noexcept;
+		const number_value* find_number_(std::size_t index) const noexcept;
+		dlink::symbol find_symbol_(std::size_t index) const noexcept;
+
+	private:
+		std::string_view codes_;
+		std::vector<std::uint8_t> types_;
+		std::vector<std::uint32_t> offsets_;
+		std::vector<std::uint32_t> lengths_;
+		std::vector<literal_entry_> literals_;
+		std::vector<number_entry_> numbers_;
+		std::vector<symbol_entry_> symbols_;
+		std::vector<std::size_t> comment_lines_;
+	};
+}
+
+#endif
\ No newline at end of file
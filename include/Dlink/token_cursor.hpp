@@ -0,0 +1,94 @@
+#ifndef DLINK_HEADER_TOKEN_CURSOR_HPP
+#define DLINK_HEADER_TOKEN_CURSOR_HPP
+
+#include <Dlink/compiler_metadata.hpp>
+#include <Dlink/lexer.hpp>
+#include <Dlink/message.hpp>
+#include <Dlink/number.hpp>
+#include <Dlink/source.hpp>
+#include <Dlink/token.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace dlink
+{
+	// Lexes a preprocessed source on demand. Tokens are produced as they are peeked at, so a caller that stops early
+	// never lexes the rest of the source. Once the last token has been produced, the diagnostics are published to the
+	// metadata in the same order and under the same conditions as lexer::lex_source.
+	class token_cursor final
+	{
+	public:
+		token_cursor(const source& source, compiler_metadata& metadata);
+		token_cursor(const token_cursor& cursor) = delete;
+		token_cursor(token_cursor&& cursor) noexcept = delete;
+		~token_cursor() = default;
+
+	public:
+		token_cursor& operator=(const token_cursor& cursor) = delete;
+		token_cursor& operator=(token_cursor&& cursor) noexcept = delete;
+		bool operator==(const token_cursor& cursor) const = delete;
+		bool operator!=(const token_cursor& cursor) const = delete;
+
+	public:
+		// Returns the token 'distance' tokens ahead of the current one, or nullptr past the last token.
+		// The pointer stays valid until the cursor moves.
+		const token* peek(std::size_t distance = 0);
+		const token* next();
+		bool eof();
+		// Returns the value of the token 'distance' tokens ahead if the lexer evaluated it as a numeric literal, or nullptr.
+		const number_value* number(std::size_t distance = 0);
+		// Returns the symbol of the token 'distance' tokens ahead if it is an identifier, or invalid_symbol.
+		dlink::symbol symbol(std::size_t distance = 0);
+
+		// Marks nest. rewind returns to the innermost mark, and release forgets it and keeps the current position.
+		void mark();
+		void rewind();
+		void release();
+
+	public:
+		std::size_t position() const noexcept;
+		bool ok() const noexcept;
+		bool finished() const noexcept;
+
+	private:
+		bool produce_(std::size_t count);
+		void lex_line_();
+		void finish_();
+		void finalize_(std::size_t index);
+		void trim_();
+
+	private:
+		// What the lexer works out about a token once no later token can merge into it.
+		struct token_value_
+		{
+			bool evaluated = false;
+			number_value number;
+			dlink::symbol symbol = invalid_symbol;
+		};
+
+	private:
+		const dlink::source& source_;
+		compiler_metadata& metadata_;
+
+		std::size_t line_ = 0;
+		lexer::line_lexing_state_ state_;
+		dlink::messages line_messages_;
+		dlink::messages token_messages_;
+		dlink::messages number_messages_;
+		bool lines_lexed_ = false;
+		bool tokens_ok_ = true;
+		bool finished_ = false;
+
+		std::vector<token> raw_tokens_;
+		std::size_t raw_index_ = 0;
+
+		std::vector<token> tokens_;
+		std::vector<token_value_> values_;		// Parallel to tokens_
+		std::size_t tokens_base_ = 0;
+		std::size_t position_ = 0;
+		std::vector<std::size_t> marks_;
+	};
+}
+
+#endif
\ No newline at end of file
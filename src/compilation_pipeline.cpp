@@ -9,6 +9,10 @@
 
 #ifdef DLINK_MULTITHREADING
 #	include <Dlink/threading.hpp>
+
+#	include <atomic>
+#	include <chrono>
+#	include <optional>
 #endif
 
 namespace dlink
@@ -32,6 +36,15 @@ namespace dlink
 		}
 	}
 
+	void compilation_pipeline::add_input(const std::string_view& path, std::string&& codes)
+	{
+		sources_.emplace_back(path, std::move(codes));
+	}
+	void compilation_pipeline::add_input(const std::string_view& path, const std::string_view& codes)
+	{
+		sources_.emplace_back(path, codes);
+	}
+
 	bool compilation_pipeline::decode()
 	{
 		return decoder::decode(metadata_, sources_);
@@ -56,79 +69,171 @@ namespace dlink
 	{
 		return lexer::lex_singlethread(metadata_, sources_);
 	}
+	bool compilation_pipeline::lex_fused()
+	{
+		return lexer::lex_fused(metadata_, sources_);
+	}
+	bool compilation_pipeline::lex_fused_singlethread()
+	{
+		return lexer::lex_fused_singlethread(metadata_, sources_);
+	}
 	
 	bool compilation_pipeline::compile_until_preprocessing()
 	{
 #ifdef DLINK_MULTITHREADING
-		auto compile_multithread = [&](std::size_t begin, std::size_t end) mutable -> bool
+		return compile_(stages_(false, false));
+#else
+		return compile_until_preprocessing_singlethread();
+#endif
+	}
+	bool compilation_pipeline::compile_until_preprocessing_singlethread()
+	{
+		return compile_singlethread_(stages_(false, false));
+	}
+	bool compilation_pipeline::compile_until_lexing()
+	{
+#ifdef DLINK_MULTITHREADING
+		return compile_(stages_(true, false));
+#else
+		return compile_until_lexing_singlethread();
+#endif
+	}
+	bool compilation_pipeline::compile_until_lexing_singlethread()
+	{
+		return compile_singlethread_(stages_(true, false));
+	}
+	bool compilation_pipeline::compile_until_lexing_fused()
+	{
+#ifdef DLINK_MULTITHREADING
+		return compile_(stages_(true, true));
+#else
+		return compile_until_lexing_fused_singlethread();
+#endif
+	}
+	bool compilation_pipeline::compile_until_lexing_fused_singlethread()
+	{
+		return compile_singlethread_(stages_(true, true));
+	}
+
+	std::vector<compilation_pipeline::stage_> compilation_pipeline::stages_(bool lex, bool fused) const
+	{
+		// Streaming already preprocesses and lexes each chunk as it is decoded, so the stages are one stage then.
+		if (metadata_.options().stream_chunk_size() != 0)
 		{
-			bool result = true;
+			if (lex)
+				return { &source::compile_until_lexing };
 
-			for (std::size_t i = begin; i < end; ++i)
-			{
-				result = result && sources_[i].compile_until_preprocessing(metadata_);
-			}
+			return { &source::compile_until_preprocessing };
+		}
 
-			return result;
-		};
+		if (lex && fused)
+			return { &source::decode, &source::lex_fused };
+		else if (lex)
+			return { &source::decode, &source::preprocess, &source::lex };
+
+		return { &source::decode, &source::preprocess };
+	}
+	std::size_t compilation_pipeline::add_inputs_()
+	{
+		const std::size_t offset = decoder::first_undecoded(sources_);
 
 		for (const std::string& path : metadata_.options().input_files())
 		{
 			sources_.emplace_back(path);
 		}
 
-		return parallel(compile_multithread, get_threading_info(metadata_));
-#else
-		return compile_until_preprocessing_singlethread();
-#endif
+		return offset;
 	}
-	bool compilation_pipeline::compile_until_preprocessing_singlethread()
+	bool compilation_pipeline::compile_singlethread_(const std::vector<stage_>& stages)
 	{
-		bool result = decode_singlethread();
+		bool result = true;
 
-		if (result)
+		for (std::size_t i = add_inputs_(); i < sources_.size(); ++i)
 		{
-			result = result && preprocess_singlethread();
+			for (stage_ stage : stages)
+			{
+				if (!(sources_[i].*stage)(metadata_))
+				{
+					result = false;
+					break;
+				}
+			}
 		}
 
 		return result;
 	}
-	bool compilation_pipeline::compile_until_lexing()
-	{
 #ifdef DLINK_MULTITHREADING
-		auto compile_multithread = [&](std::size_t begin, std::size_t end) mutable -> bool
+	bool compilation_pipeline::compile_(const std::vector<stage_>& stages)
+	{
+		using clock = std::chrono::steady_clock;
+
+		const std::size_t files_offset = sources_.size();
+		const std::size_t offset = add_inputs_();
+
+		// Files read ahead are handed out in the order they are read, so that workers rarely wait for a file the readers
+		// have not reached yet. Otherwise the largest sources come first, as they decide the makespan.
+		const bool reads_ahead = metadata_.options().read_ahead_depth() != 0 && metadata_.options().stream_chunk_size() == 0;
+		const threading_info info = reads_ahead ?
+			get_threading_info(metadata_, sources_.size() - offset) : get_threading_info(metadata_, sources_, offset);
+		if (info.count_of_threads == 0)
+			return true;
+
+		std::optional<read_ahead> reader;
+		if (reads_ahead)
+		{
+			reader.emplace(metadata_.options().input_files(), metadata_.options().map_input(), metadata_.options().read_ahead_depth());
+		}
+
+		std::atomic<clock::rep> busy_time{ 0 };
+		task_graph graph;
+
+		// Each stage of a source depends only on the previous stage of the same source, so a source can be lexed while
+		// another one is still being read.
+		auto add_source = [&](std::size_t index)
 		{
-			bool result = true;
+			source& src = sources_[index];
 
-			for (std::size_t i = begin; i < end; ++i)
+			for (std::size_t i = 0; i < stages.size(); ++i)
 			{
-				result = result && sources_[i].compile_until_lexing(metadata_);
-			}
+				const std::size_t task = graph.add([this, &src, &reader, &busy_time, stage = stages[i], index, first = i == 0, files_offset]
+				{
+					const clock::time_point begin = clock::now();
+					const bool result = first && reader && index >= files_offset ?
+						decoder::decode_source(src, metadata_, reader->take(index - files_offset)) : (src.*stage)(metadata_);
+
+					busy_time.fetch_add((clock::now() - begin).count(), std::memory_order_relaxed);
+					return result;
+				});
 
-			return result;
+				if (i != 0)
+				{
+					graph.depend(task, task - 1);
+				}
+			}
 		};
 
-		for (const std::string& path : metadata_.options().input_files())
+		if (info.order.empty())
 		{
-			sources_.emplace_back(path);
+			for (std::size_t i = offset; i < sources_.size(); ++i)
+			{
+				add_source(i);
+			}
 		}
-
-		return parallel(compile_multithread, get_threading_info(metadata_));
-#else
-		return compile_until_lexing_singlethread();
-#endif
-	}
-	bool compilation_pipeline::compile_until_lexing_singlethread()
-	{
-		bool result = compile_until_preprocessing_singlethread();
-
-		if (result)
+		else
 		{
-			result = result && lex_singlethread();
+			for (std::size_t job : info.order)
+			{
+				add_source(offset + job);
+			}
 		}
 
+		const clock::time_point begin = clock::now();
+		const bool result = graph.run(thread_pool::shared(info.count_of_threads), info.count_of_threads);
+
+		record_schedule(metadata_, "compile", info, clock::now() - begin, clock::duration(busy_time.load(std::memory_order_relaxed)));
 		return result;
 	}
+#endif
 
 	nlohmann::json compilation_pipeline::dump_sources() const
 	{
@@ -29,4 +29,29 @@ namespace dlink
 	{
 		return options_;
 	}
+	const dlink::interner& compiler_metadata::interner() const noexcept
+	{
+		return interner_;
+	}
+	dlink::interner& compiler_metadata::interner() noexcept
+	{
+		return interner_;
+	}
+
+	void compiler_metadata::add_schedule(stage_schedule&& schedule)
+	{
+#ifdef DLINK_MULTITHREADING
+		std::lock_guard<std::mutex> guard(schedules_mutex_);
+#endif
+
+		schedules_.push_back(std::move(schedule));
+	}
+	std::vector<stage_schedule> compiler_metadata::schedules() const
+	{
+#ifdef DLINK_MULTITHREADING
+		std::lock_guard<std::mutex> guard(schedules_mutex_);
+#endif
+
+		return schedules_;
+	}
 }
\ No newline at end of file
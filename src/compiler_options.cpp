@@ -13,18 +13,20 @@ namespace dlink
 	compiler_options::compiler_options(const compiler_options& options)
 		: help_(options.help_), version_(options.version_),
 #ifdef DLINK_MULTITHREADING
-		count_of_threads_(options.count_of_threads_),
+		count_of_threads_(options.count_of_threads_), read_ahead_depth_(options.read_ahead_depth_), lex_chunk_size_(options.lex_chunk_size_),
 #endif
 		input_files_(options.input_files_), output_file_(options.output_file_),
-		input_encoding_(options.input_encoding_)
+		input_encoding_(options.input_encoding_), map_input_(options.map_input_),
+		stream_chunk_size_(options.stream_chunk_size_)
 	{}
 	compiler_options::compiler_options(compiler_options&& options) noexcept
 		: help_(options.help_), version_(options.version_),
 #ifdef DLINK_MULTITHREADING
-		count_of_threads_(options.count_of_threads_),
+		count_of_threads_(options.count_of_threads_), read_ahead_depth_(options.read_ahead_depth_), lex_chunk_size_(options.lex_chunk_size_),
 #endif
 		input_files_(std::move(options.input_files_)), output_file_(std::move(options.output_file_)),
-		input_encoding_(std::move(options.input_encoding_))
+		input_encoding_(std::move(options.input_encoding_)), map_input_(options.map_input_),
+		stream_chunk_size_(options.stream_chunk_size_)
 	{
 		options.moved_();
 	}
@@ -36,6 +38,8 @@ namespace dlink
 
 #ifdef DLINK_MULTITHREADING
 		count_of_threads_ = options.count_of_threads_;
+		read_ahead_depth_ = options.read_ahead_depth_;
+		lex_chunk_size_ = options.lex_chunk_size_;
 #endif
 		input_files_ = options.input_files_;
 		output_file_ = options.output_file_;
@@ -43,6 +47,8 @@ namespace dlink
 		macros_ = options.macros_;
 
 		input_encoding_ = options.input_encoding_;
+		map_input_ = options.map_input_;
+		stream_chunk_size_ = options.stream_chunk_size_;
 
 		return *this;
 	}
@@ -53,6 +59,8 @@ namespace dlink
 
 #ifdef DLINK_MULTITHREADING
 		count_of_threads_ = options.count_of_threads_;
+		read_ahead_depth_ = options.read_ahead_depth_;
+		lex_chunk_size_ = options.lex_chunk_size_;
 #endif
 		input_files_ = std::move(options.input_files_);
 		output_file_ = std::move(options.output_file_);
@@ -60,6 +68,8 @@ namespace dlink
 		macros_ = std::move(options.macros_);
 
 		input_encoding_ = std::move(options.input_encoding_);
+		map_input_ = options.map_input_;
+		stream_chunk_size_ = options.stream_chunk_size_;
 
 		options.moved_();
 
@@ -74,6 +84,13 @@ namespace dlink
 		macros_.clear();
 
 		input_encoding_ = encoding::none;
+		map_input_ = true;
+		stream_chunk_size_ = 0;
+
+#ifdef DLINK_MULTITHREADING
+		read_ahead_depth_ = default_read_ahead_depth;
+		lex_chunk_size_ = default_lex_chunk_size;
+#endif
 
 		moved_();
 	}
@@ -141,6 +158,34 @@ namespace dlink
 
 		count_of_threads_ = new_count_of_threads;
 	}
+#endif
+	std::size_t compiler_options::read_ahead_depth() const noexcept
+	{
+#ifdef DLINK_MULTITHREADING
+		return read_ahead_depth_;
+#else
+		return 0;
+#endif
+	}
+#ifdef DLINK_MULTITHREADING
+	void compiler_options::read_ahead_depth(std::size_t new_read_ahead_depth) noexcept
+	{
+		read_ahead_depth_ = new_read_ahead_depth;
+	}
+#endif
+	std::size_t compiler_options::lex_chunk_size() const noexcept
+	{
+#ifdef DLINK_MULTITHREADING
+		return lex_chunk_size_;
+#else
+		return 0;
+#endif
+	}
+#ifdef DLINK_MULTITHREADING
+	void compiler_options::lex_chunk_size(std::size_t new_lex_chunk_size) noexcept
+	{
+		lex_chunk_size_ = new_lex_chunk_size;
+	}
 #endif
 	const std::vector<std::string>& compiler_options::input_files() const noexcept
 	{
@@ -168,6 +213,22 @@ namespace dlink
 	{
 		input_encoding_ = new_encoding_type;
 	}
+	bool compiler_options::map_input() const noexcept
+	{
+		return map_input_;
+	}
+	void compiler_options::map_input(bool new_map_input) noexcept
+	{
+		map_input_ = new_map_input;
+	}
+	std::size_t compiler_options::stream_chunk_size() const noexcept
+	{
+		return stream_chunk_size_;
+	}
+	void compiler_options::stream_chunk_size(std::size_t new_stream_chunk_size) noexcept
+	{
+		stream_chunk_size_ = new_stream_chunk_size;
+	}
 }
 
 namespace dlink
@@ -199,7 +260,14 @@ namespace dlink
 			()
 			(",D", "Define the macro for preprocessor.", command_parameter::string, command_parameter_format::separated | command_parameter_format::attached)
 			()
-			(",finput-encoding", "Set the input encoding.", command_parameter::string, command_parameter_format::separated | command_parameter_format::assigned);
+			(",finput-encoding", "Set the input encoding.", command_parameter::string, command_parameter_format::separated | command_parameter_format::assigned)
+			(",fno-map-input", "Read the input files into memory instead of mapping them.")
+			(",fstream-chunk-size", "Decode, preprocess and lex the mapped input files in chunks of 'arg' bytes.", command_parameter::integer, command_parameter_format::separated | command_parameter_format::assigned)
+#ifdef DLINK_MULTITHREADING
+			(",fread-ahead", "Set how many input files are read ahead of compiling (0 to disable).", command_parameter::integer, command_parameter_format::separated | command_parameter_format::assigned)
+			(",flex-chunk-size", "Lex sources larger than 'arg' bytes in chunks of 'arg' bytes in parallel (0 to disable).", command_parameter::integer, command_parameter_format::separated | command_parameter_format::assigned)
+#endif
+			;
 		parser.accept_non_command = true;
 
 		try
@@ -233,6 +301,44 @@ namespace dlink
 				const std::int32_t count = std::clamp(std::any_cast<int>(result.argument("-j").front()), 0, compiler_options::max_count_of_threads);
 				options.count_of_threads(count);
 			}
+
+			temp = result.count("-fread-ahead");
+			if (temp)
+			{
+				if (temp >= 2)
+				{
+					stream << "Error: '-fread-ahead' was used more than once.\n\n";
+					return false;
+				}
+
+				const int depth = std::any_cast<int>(result.argument("-fread-ahead").front());
+				if (depth < 0)
+				{
+					stream << "Error: the argument ('" << depth << "') for option '-fread-ahead' must not be negative.\n\n";
+					return false;
+				}
+
+				options.read_ahead_depth(static_cast<std::size_t>(depth));
+			}
+
+			temp = result.count("-flex-chunk-size");
+			if (temp)
+			{
+				if (temp >= 2)
+				{
+					stream << "Error: '-flex-chunk-size' was used more than once.\n\n";
+					return false;
+				}
+
+				const int chunk_size = std::any_cast<int>(result.argument("-flex-chunk-size").front());
+				if (chunk_size < 0)
+				{
+					stream << "Error: the argument ('" << chunk_size << "') for option '-flex-chunk-size' must not be negative.\n\n";
+					return false;
+				}
+
+				options.lex_chunk_size(static_cast<std::size_t>(chunk_size));
+			}
 #endif
 			temp = result.count("-o");
 			if (temp)
@@ -331,6 +437,30 @@ namespace dlink
 				}
 			}
 
+			if (result.count("-fno-map-input"))
+			{
+				options.map_input(false);
+			}
+
+			temp = result.count("-fstream-chunk-size");
+			if (temp)
+			{
+				if (temp >= 2)
+				{
+					stream << "Error: '-fstream-chunk-size' was used more than once.\n\n";
+					return false;
+				}
+
+				const int chunk_size = std::any_cast<int>(result.argument("-fstream-chunk-size").front());
+				if (chunk_size <= 0)
+				{
+					stream << "Error: the argument ('" << chunk_size << "') for option '-fstream-chunk-size' must be positive.\n\n";
+					return false;
+				}
+
+				options.stream_chunk_size(static_cast<std::size_t>(chunk_size));
+			}
+
 			const std::vector<std::any> input = result.non_command();
 			for (const std::any& file : input)
 			{
@@ -5,8 +5,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <fstream>
 #include <iterator>
 #include <memory>
+#include <string_view>
 
 #ifdef DLINK_MULTITHREADING
 #	include <Dlink/threading.hpp>
@@ -15,8 +17,6 @@
 #	include <mutex>
 #endif
 
-#include <Dlink/extlib/utf8/utf8.h>
-
 namespace dlink
 {
 	bool decoder::decode(compiler_metadata& metadata, std::vector<source>& results)
@@ -34,23 +34,27 @@ namespace dlink
 			return result;
 		};
 
-		const std::size_t offset = results.size();
+		const std::size_t offset = first_undecoded(results);
 
 		for (const std::string& path : metadata.options().input_files())
 		{
 			results.emplace_back(path);
 		}
 
-		return parallel(decode_multithread, get_threading_info(metadata), offset);
+		return parallel(decode_multithread, get_threading_info(metadata, results, offset), metadata, "decode", offset);
 #else
 		return decode_singlethread(metadata, results);
 #endif
 	}
 	bool decoder::decode_singlethread(compiler_metadata& metadata, std::vector<source>& results)
 	{
-		const std::size_t size = results.size();
 		bool result = true;
 
+		for (std::size_t i = first_undecoded(results); i < results.size(); ++i)
+		{
+			result = decode_source(results[i], metadata) && result;
+		}
+
 		for (const std::string& path : metadata.options().input_files())
 		{
 			source& src = results.emplace_back(path);
@@ -59,14 +63,38 @@ namespace dlink
 
 		return result;
 	}
+	std::size_t decoder::first_undecoded(const std::vector<source>& sources) noexcept
+	{
+		std::size_t first = sources.size();
+
+		while (first > 0 && sources[first - 1].state() == source_state::initialized)
+		{
+			--first;
+		}
+
+		return first;
+	}
 	bool decoder::decode_source(source& source, compiler_metadata& metadata)
 	{
 		if (source.state() < source_state::initialized)
 			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::initialized' or higher when 'static bool dlink::decoder::decode_source(dlink::source&, dlink::compiler_metadata&)' method is called.");
 
-		std::ifstream stream(source.path(), std::ios::binary);
+		if (source.input_.loaded)
+		{
+			raw_input input = std::move(source.input_);
+			source.input_ = raw_input();
 
-		if (!stream.is_open())
+			return decode_source(source, metadata, std::move(input));
+		}
+
+		return decode_source(source, metadata, read_source(source.path(), metadata.options().map_input()));
+	}
+	bool decoder::decode_source(source& source, compiler_metadata& metadata, raw_input&& input)
+	{
+		if (source.state() < source_state::initialized)
+			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::initialized' or higher when 'static bool dlink::decoder::decode_source(dlink::source&, dlink::compiler_metadata&, dlink::raw_input&&)' method is called.");
+
+		if (!input.loaded)
 		{
 			metadata.messages().push_back(std::make_shared<error_message>(
 				1000, message_data::def.error(1000)(), source.path()
@@ -75,7 +103,19 @@ namespace dlink
 			return false;
 		}
 
-		encoding detected_encoding = detect_encoding(stream);
+		std::string_view bytes = input.buffer;
+
+		if (input.mapping.is_open())
+		{
+			bytes = std::string_view(input.mapping.data(), input.mapping.size());
+		}
+		else if (input.borrowed.data())
+		{
+			bytes = input.borrowed;
+		}
+
+		std::size_t bom_size;
+		const encoding detected_encoding = detect_encoding(bytes, bom_size);
 
 		if (metadata.options().input_encoding() != encoding::none &&
 			metadata.options().input_encoding() != detected_encoding)
@@ -87,37 +127,25 @@ namespace dlink
 			return false;
 		}
 
-		const std::streampos pos = stream.tellg();
-		stream.seekg(0, std::ios::end);
-
-		const std::streamoff length = stream.tellg() - pos;
-		stream.seekg(pos, std::ios::beg);
+		const std::string_view contents = bytes.substr(bom_size);
 
 		switch (detected_encoding)
 		{
 		case encoding::utf16:
-			return decode_utf16_(endian::little_endian, length, detected_encoding, stream,
-								 source, metadata);
-			
+			return decode_utf16_(endian::little_endian, contents, detected_encoding, source, metadata);
+
 		case encoding::utf16be:
-			return decode_utf16_(endian::big_endian, length, detected_encoding, stream,
-				source, metadata);
+			return decode_utf16_(endian::big_endian, contents, detected_encoding, source, metadata);
 
 		case encoding::utf32:
-			return decode_utf32_(endian::little_endian, length, detected_encoding, stream,
-				source, metadata);
-			
+			return decode_utf32_(endian::little_endian, contents, detected_encoding, source, metadata);
+
 		case encoding::utf32be:
-			return decode_utf32_(endian::big_endian, length, detected_encoding, stream,
-				source, metadata);
+			return decode_utf32_(endian::big_endian, contents, detected_encoding, source, metadata);
 
 		default:
 		{
-			std::string str(static_cast<std::size_t>(length - pos), 0);
-			stream.read(reinterpret_cast<char*>(str.data()), str.size());
-			std::string::iterator invalid_iter = utf8::find_invalid(str.begin(), str.end());
-
-			if (invalid_iter != str.end())
+			if (!validate_utf8(contents).valid)
 			{
 				metadata.messages().push_back(std::make_shared<error_message>(
 					1001, message_data::def.error(1001)("UTF-8"), source.path()
@@ -126,75 +154,286 @@ namespace dlink
 				return false;
 			}
 
-			source.codes(std::move(str));
+			if (input.mapping.is_open())
+			{
+				source.codes(std::move(input.mapping), bom_size);
+			}
+			else if (input.borrowed.data())
+			{
+				source.codes(input.borrowed, bom_size);
+			}
+			else
+			{
+				source.codes(std::move(input.buffer), bom_size);
+			}
+
 			return true;
 		}
 		}
 	}
 
-	bool decoder::decode_utf16_(const endian encoding_endian, const std::fpos_t length, const encoding detected_encoding,
-								std::ifstream& stream, source& source, compiler_metadata& metadata)
+	raw_input decoder::read_source(const std::string& path, bool map_input)
+	{
+		raw_input input;
+
+		if (map_input && input.mapping.open(path))
+		{
+			input.loaded = true;
+		}
+		else
+		{
+			input.loaded = read_file_(path, input.buffer);
+		}
+
+		return input;
+	}
+
+	bool decoder::read_file_(const std::string& path, std::string& buffer)
 	{
-		if (length % 2 != 0)
+		std::ifstream stream(path, std::ios::binary);
+
+		if (!stream.is_open())
+			return false;
+
+		stream.seekg(0, std::ios::end);
+		const std::streamoff length = stream.tellg();
+		stream.seekg(0, std::ios::beg);
+
+		if (length > 0)
+		{
+			buffer.resize(static_cast<std::size_t>(length));
+			stream.read(buffer.data(), length);
+			buffer.resize(static_cast<std::size_t>(stream.gcount()));
+		}
+		else
+		{
+			buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		}
+
+		return true;
+	}
+	bool decoder::decode_utf16_(const endian encoding_endian, const std::string_view& bytes, const encoding detected_encoding,
+								source& source, compiler_metadata& metadata)
+	{
+		std::string utf8;
+
+		if (!utf16_to_utf8(bytes, encoding_endian, utf8))
 		{
 			metadata.messages().push_back(std::make_shared<error_message>(
-				1001, message_data::def.error(1001)(to_string(detected_encoding))
+				1001, message_data::def.error(1001)(to_string(detected_encoding)), source.path()
 				));
 
 			return false;
 		}
 
-		std::u16string temp(static_cast<std::size_t>(length / 2), 0);
-		stream.read(reinterpret_cast<char*>(temp.data()), temp.size() * 2);
+		source.codes(std::move(utf8));
 
-		const endian system_endian = get_endian();
+		return true;
+	}
+	bool decoder::decode_utf32_(const endian encoding_endian, const std::string_view& bytes, const encoding detected_encoding,
+								source& source, compiler_metadata& metadata)
+	{
+		std::string utf8;
 
-		if ((system_endian == endian::big_endian && encoding_endian == endian::little_endian) ||
-			(system_endian == endian::little_endian && encoding_endian == endian::big_endian))
+		if (!utf32_to_utf8(bytes, encoding_endian, utf8))
 		{
-			std::transform(temp.begin(), temp.end(), temp.begin(), [](char16_t c)
-			{
-				return static_cast<char16_t>(((c & 0xFF) << 8) + ((c & 0xFF00) >> 8));
-			});
-		}
+			metadata.messages().push_back(std::make_shared<error_message>(
+				1001, message_data::def.error(1001)(to_string(detected_encoding)), source.path()
+				));
 
-		std::string utf8;
-		utf8::utf16to8(temp.begin(), temp.end(), std::back_inserter(utf8));
+			return false;
+		}
 
 		source.codes(std::move(utf8));
 
 		return true;
 	}
-	bool decoder::decode_utf32_(const endian encoding_endian, const std::fpos_t length, const encoding detected_encoding,
-								std::ifstream& stream, source& source, compiler_metadata& metadata)
+
+	decoding_stream::decoding_stream(source& source, compiler_metadata& metadata, std::size_t chunk_size)
+		: source_(source), metadata_(metadata), chunk_size_(std::max<std::size_t>(chunk_size, 4))
 	{
-		if (length % 4 != 0)
+		if (metadata.options().map_input() && input_.open(source.path()))
 		{
-			metadata.messages().push_back(std::make_shared<error_message>(
-				1001, message_data::def.error(1001)(to_string(detected_encoding))
+			bytes_ = std::string_view(input_.data(), input_.size());
+		}
+	}
+
+	bool decoding_stream::read()
+	{
+		if (eof_)
+			return true;
+
+		if (!opened_ && !open_())
+			return false;
+
+		// The lines before the pending one were lexed with the previous chunks, and so was the input they were transcoded
+		// from. Their pages are given back, and read from the input again if a diagnostic or a dump needs them.
+		if (source_.codes_mapping_.is_open())
+		{
+			source_.codes_mapping_.release(source_.codes_offset_ + line_begin_);
+		}
+		else
+		{
+			input_.release(static_cast<std::size_t>(bytes_.data() - input_.data()) + read_);
+		}
+
+		const std::string_view bytes = bytes_.substr(read_, chunk_size_);
+		eof_ = read_ + bytes.size() == bytes_.size();
+
+		if (!decode_(bytes))
+			return false;
+
+		// Mapped codes are decoded as far as they are read, and transcoded ones as far as they are written.
+		const std::string_view codes = source_.codes();
+		const std::size_t end = source_.codes_mapping_.is_open() ? read_ : codes.size();
+
+		if (eof_)
+		{
+			source_.lines_.append(codes, line_begin_, end);
+			source_.publish_(source_state::decoded);
+		}
+		else
+		{
+			line_begin_ = source_.lines_.append_partial(codes, line_begin_, scanned_, end);
+		}
+
+		return true;
+	}
+	bool decoding_stream::eof() const noexcept
+	{
+		return eof_;
+	}
+	bool decoding_stream::is_open() const noexcept
+	{
+		return bytes_.data() != nullptr;
+	}
+
+	bool decoding_stream::open_()
+	{
+		std::size_t bom_size;
+		encoding_ = detect_encoding(bytes_, bom_size);
+		opened_ = true;
+
+		if (metadata_.options().input_encoding() != encoding::none &&
+			metadata_.options().input_encoding() != encoding_)
+		{
+			metadata_.messages().push_back(std::make_shared<error_message>(
+				1002, message_data::def.error(1002)(to_string(metadata_.options().input_encoding())), source_.path()
 				));
 
+			eof_ = true;
 			return false;
 		}
 
-		std::u32string temp(static_cast<std::size_t>(length / 4), 0);
-		stream.read(reinterpret_cast<char*>(temp.data()), temp.size() * 4);
+		bytes_.remove_prefix(bom_size);
 
-		const endian system_endian = get_endian();
+		// The codes are filled in without publishing them, as the source is only decoded once the whole input is.
+		source_.codes_.clear();
+		source_.codes_borrowed_ = {};
+		source_.codes_offset_ = 0;
+		source_.lines_.clear();
 
-		if ((system_endian == endian::big_endian && encoding_endian == endian::little_endian) ||
-			(system_endian == endian::little_endian && encoding_endian == endian::big_endian))
+		switch (encoding_)
 		{
-			std::transform(temp.begin(), temp.end(), temp.begin(), [](char32_t c)
+		case encoding::utf16:
+		case encoding::utf16be:
+			source_.codes_mapping_.close();
+			source_.codes_.reserve(bytes_.size() / 2 * 3);
+			break;
+
+		case encoding::utf32:
+		case encoding::utf32be:
+			source_.codes_mapping_.close();
+			source_.codes_.reserve(bytes_.size());
+			break;
+
+		default:
+			source_.codes_mapping_ = std::move(input_);
+			source_.codes_offset_ = bom_size;
+			break;
+		}
+
+		return true;
+	}
+	bool decoding_stream::decode_(const std::string_view& bytes)
+	{
+		std::size_t size = bytes.size();
+		bool result;
+
+		// Units or sequences cut at the end of the chunk are left to be read again with the next chunk.
+		switch (encoding_)
+		{
+		case encoding::utf16:
+		case encoding::utf16be:
+		{
+			const endian byte_order = encoding_ == encoding::utf16 ? endian::little_endian : endian::big_endian;
+
+			if (!eof_)
 			{
-				return static_cast<char32_t>(((c & 0xFF000000) >> 24) + ((c & 0xFF0000) >> 8) + ((c & 0xFF00) << 8) + ((c & 0xFF) << 24));
-			});
+				size -= size % 2;
+
+				if (size >= 2)
+				{
+					const char high = byte_order == endian::little_endian ? bytes[size - 1] : bytes[size - 2];
+					if ((static_cast<unsigned char>(high) & 0xFC) == 0xD8)
+					{
+						size -= 2;
+					}
+				}
+			}
+
+			result = utf16_to_utf8(bytes.substr(0, size), byte_order, source_.codes_);
+			break;
 		}
 
-		std::string utf8;
-		utf8::utf32to8(temp.begin(), temp.end(), std::back_inserter(utf8));
+		case encoding::utf32:
+		case encoding::utf32be:
+			if (!eof_)
+			{
+				size -= size % 4;
+			}
 
-		source.codes(std::move(utf8));
+			result = utf32_to_utf8(bytes.substr(0, size),
+								   encoding_ == encoding::utf32 ? endian::little_endian : endian::big_endian, source_.codes_);
+			break;
+
+		default:
+			if (!eof_)
+			{
+				for (std::size_t back = 1; back <= 3 && back <= size; ++back)
+				{
+					const char c = bytes[size - back];
+					if ((static_cast<unsigned char>(c) & 0xC0) == 0x80) continue;
+
+					if (get_character_length(c) > static_cast<int>(back))
+					{
+						size -= back;
+					}
+
+					break;
+				}
+			}
+
+			result = validate_utf8(bytes.substr(0, size)).valid;
+			break;
+		}
+
+		if (!result)
+		{
+			metadata_.messages().push_back(std::make_shared<error_message>(
+				1001, message_data::def.error(1001)(encoding_ == encoding::none ? "UTF-8" : to_string(encoding_)), source_.path()
+				));
+
+			source_.codes_mapping_.close();
+			std::string().swap(source_.codes_);
+			source_.codes_offset_ = 0;
+			source_.lines_.clear();
+
+			eof_ = true;
+			return false;
+		}
+
+		read_ += size;
 
 		return true;
 	}
@@ -1,10 +1,20 @@
 #include <Dlink/encoding.hpp>
 
+#include <Dlink/system.hpp>
+
 #include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <cstring>
+
+#ifdef DLINK_X86
+#	include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
 
-#include <boost/iostreams/stream.hpp>
-#include <boost/iostreams/device/array.hpp>
+#include <Dlink/extlib/utf8/utf8.h>
 
 namespace dlink
 {
@@ -87,6 +97,32 @@ namespace dlink
 		stream.seekg(pos, std::ios::beg);
 		return encoding::none;
 	}
+	encoding detect_encoding(const std::string_view& bytes, std::size_t& bom_size) noexcept
+	{
+		static constexpr std::string_view utf8_bom = "\xEF\xBB\xBF";
+		static constexpr std::string_view utf16_bom = "\xFF\xFE";
+		static constexpr std::string_view utf16be_bom = "\xFE\xFF";
+		static constexpr std::string_view utf32_bom("\xFF\xFE\x00\x00", 4);
+		static constexpr std::string_view utf32be_bom("\x00\x00\xFE\xFF", 4);
+
+		const auto starts_with = [&bytes, &bom_size](const std::string_view& bom)
+		{
+			if (bytes.substr(0, bom.size()) != bom) return false;
+
+			bom_size = bom.size();
+			return true;
+		};
+
+		bom_size = 0;
+
+		if (starts_with(utf32_bom)) return encoding::utf32;
+		else if (starts_with(utf32be_bom)) return encoding::utf32be;
+		else if (starts_with(utf8_bom)) return encoding::utf8;
+		else if (starts_with(utf16_bom)) return encoding::utf16;
+		else if (starts_with(utf16be_bom)) return encoding::utf16be;
+
+		return encoding::none;
+	}
 
 	int get_character_length(char first_byte)
 	{
@@ -113,6 +149,666 @@ namespace dlink
 	}
 }
 
+namespace dlink
+{
+	namespace
+	{
+		namespace utf8_validation
+		{
+			// Error bits of the lookup algorithm by John Keiser and Daniel Lemire ("Validating UTF-8 In Less Than
+			// One Instruction Per Byte"). Each table maps a nibble to every error the nibble can take part in, so
+			// a pair of bytes is invalid exactly when the three lookups share a bit.
+			constexpr std::uint8_t too_short = 1 << 0;
+			constexpr std::uint8_t too_long = 1 << 1;
+			constexpr std::uint8_t overlong_3 = 1 << 2;
+			constexpr std::uint8_t too_large = 1 << 3;
+			constexpr std::uint8_t surrogate = 1 << 4;
+			constexpr std::uint8_t overlong_2 = 1 << 5;
+			constexpr std::uint8_t too_large_1000 = 1 << 6;
+			constexpr std::uint8_t overlong_4 = 1 << 6;
+			constexpr std::uint8_t two_conts = 1 << 7;
+			constexpr std::uint8_t carry = too_short | too_long | two_conts;
+
+			alignas(16) constexpr std::uint8_t byte_1_high[16] =
+			{
+				too_long, too_long, too_long, too_long,
+				too_long, too_long, too_long, too_long,
+				two_conts, two_conts, two_conts, two_conts,
+				too_short | overlong_2,
+				too_short,
+				too_short | overlong_3 | surrogate,
+				too_short | too_large | too_large_1000 | overlong_4,
+			};
+			alignas(16) constexpr std::uint8_t byte_1_low[16] =
+			{
+				carry | overlong_3 | overlong_2 | overlong_4,
+				carry | overlong_2,
+				carry,
+				carry,
+				carry | too_large,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000 | surrogate,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+			};
+			alignas(16) constexpr std::uint8_t byte_2_high[16] =
+			{
+				too_short, too_short, too_short, too_short,
+				too_short, too_short, too_short, too_short,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_short, too_short, too_short, too_short,
+			};
+
+			// A block is incomplete when one of its last three bytes starts a sequence that doesn't fit in it.
+			// Blocks narrower than 64 bytes use the tail of the table.
+			alignas(64) constexpr std::uint8_t incomplete_max[64] =
+			{
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+				0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+			};
+
+			constexpr std::uint8_t third_byte_min = 0xE0 - 0x80;
+			constexpr std::uint8_t fourth_byte_min = 0xF0 - 0x80;
+
+			utf8_validation_result validate_scalar(const char* data, std::size_t size) noexcept
+			{
+				std::size_t i = 0;
+
+				for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t))
+				{
+					std::uint64_t word;
+					std::memcpy(&word, data + i, sizeof(word));
+
+					if (word & 0x8080808080808080) break;
+				}
+				while (i < size && static_cast<unsigned char>(data[i]) < 0x80)
+				{
+					++i;
+				}
+
+				if (i == size) return { true, true };
+				else return { utf8::find_invalid(data + i, data + size) == data + size, false };
+			}
+
+#ifdef DLINK_X86
+			DLINK_TARGET("sse4.2") inline __m128i check_sse42(__m128i input, __m128i prev_input) noexcept
+			{
+				const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+
+				const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+				const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+				const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+				const __m128i byte_1_high_error = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(byte_1_high)),
+																   _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask));
+				const __m128i byte_1_low_error = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(byte_1_low)),
+																  _mm_and_si128(prev1, nibble_mask));
+				const __m128i byte_2_high_error = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(byte_2_high)),
+																   _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask));
+				const __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high_error, byte_1_low_error), byte_2_high_error);
+
+				const __m128i must_be_continuation = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(third_byte_min))),
+																  _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(fourth_byte_min))));
+
+				return _mm_xor_si128(_mm_and_si128(must_be_continuation, _mm_set1_epi8(static_cast<char>(0x80))), special_cases);
+			}
+			DLINK_TARGET("sse4.2") utf8_validation_result validate_sse42(const char* data, std::size_t size) noexcept
+			{
+				const __m128i max_value = _mm_load_si128(reinterpret_cast<const __m128i*>(incomplete_max + 48));
+
+				__m128i error = _mm_setzero_si128();
+				__m128i prev_input = _mm_setzero_si128();
+				__m128i prev_incomplete = _mm_setzero_si128();
+				bool ascii = true;
+
+				alignas(16) char tail[16];
+				std::size_t i = 0;
+
+				while (i < size)
+				{
+					__m128i input;
+
+					if (i + 16 <= size)
+					{
+						input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					}
+					else
+					{
+						std::memset(tail, ' ', sizeof(tail));
+						std::memcpy(tail, data + i, size - i);
+						input = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+					}
+
+					if (_mm_movemask_epi8(input) == 0)
+					{
+						error = _mm_or_si128(error, prev_incomplete);
+						prev_incomplete = _mm_setzero_si128();
+					}
+					else
+					{
+						ascii = false;
+						error = _mm_or_si128(error, check_sse42(input, prev_input));
+						prev_incomplete = _mm_subs_epu8(input, max_value);
+					}
+
+					prev_input = input;
+					i += 16;
+				}
+
+				error = _mm_or_si128(error, prev_incomplete);
+
+				return { _mm_testz_si128(error, error) != 0, ascii };
+			}
+
+			DLINK_TARGET("avx2") inline __m256i check_avx2(__m256i input, __m256i prev_input) noexcept
+			{
+				const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+
+				const __m256i shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+				const __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+				const __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+				const __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+
+				const __m256i byte_1_high_error = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(byte_1_high))),
+																	  _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble_mask));
+				const __m256i byte_1_low_error = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(byte_1_low))),
+																	 _mm256_and_si256(prev1, nibble_mask));
+				const __m256i byte_2_high_error = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(byte_2_high))),
+																	  _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask));
+				const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high_error, byte_1_low_error), byte_2_high_error);
+
+				const __m256i must_be_continuation = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(third_byte_min))),
+																	 _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(fourth_byte_min))));
+
+				return _mm256_xor_si256(_mm256_and_si256(must_be_continuation, _mm256_set1_epi8(static_cast<char>(0x80))), special_cases);
+			}
+			DLINK_TARGET("avx2") utf8_validation_result validate_avx2(const char* data, std::size_t size) noexcept
+			{
+				const __m256i max_value = _mm256_load_si256(reinterpret_cast<const __m256i*>(incomplete_max + 32));
+
+				__m256i error = _mm256_setzero_si256();
+				__m256i prev_input = _mm256_setzero_si256();
+				__m256i prev_incomplete = _mm256_setzero_si256();
+				bool ascii = true;
+
+				alignas(32) char tail[32];
+				std::size_t i = 0;
+
+				while (i < size)
+				{
+					__m256i input;
+
+					if (i + 32 <= size)
+					{
+						input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					}
+					else
+					{
+						std::memset(tail, ' ', sizeof(tail));
+						std::memcpy(tail, data + i, size - i);
+						input = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+					}
+
+					if (_mm256_movemask_epi8(input) == 0)
+					{
+						error = _mm256_or_si256(error, prev_incomplete);
+						prev_incomplete = _mm256_setzero_si256();
+					}
+					else
+					{
+						ascii = false;
+						error = _mm256_or_si256(error, check_avx2(input, prev_input));
+						prev_incomplete = _mm256_subs_epu8(input, max_value);
+					}
+
+					prev_input = input;
+					i += 32;
+				}
+
+				error = _mm256_or_si256(error, prev_incomplete);
+
+				return { _mm256_testz_si256(error, error) != 0, ascii };
+			}
+
+			// Repeats a table in every lane. The zero-masking form is the same instruction, but GCC 12 warns about the undefined
+			// value the unmasked one merges with.
+			DLINK_TARGET("avx512f") inline __m512i broadcast_table_avx512(const std::uint8_t* table) noexcept
+			{
+				return _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128(reinterpret_cast<const __m128i*>(table)));
+			}
+			DLINK_TARGET("avx512f,avx512bw") inline __m512i check_avx512(__m512i input, __m512i prev_input) noexcept
+			{
+				const __m512i nibble_mask = _mm512_set1_epi8(0x0F);
+
+				const __m512i shifted = _mm512_permutex2var_epi64(prev_input, _mm512_set_epi64(13, 12, 11, 10, 9, 8, 7, 6), input);
+				const __m512i prev1 = _mm512_alignr_epi8(input, shifted, 15);
+				const __m512i prev2 = _mm512_alignr_epi8(input, shifted, 14);
+				const __m512i prev3 = _mm512_alignr_epi8(input, shifted, 13);
+
+				const __m512i byte_1_high_error = _mm512_shuffle_epi8(broadcast_table_avx512(byte_1_high),
+																	  _mm512_and_si512(_mm512_srli_epi16(prev1, 4), nibble_mask));
+				const __m512i byte_1_low_error = _mm512_shuffle_epi8(broadcast_table_avx512(byte_1_low),
+																	 _mm512_and_si512(prev1, nibble_mask));
+				const __m512i byte_2_high_error = _mm512_shuffle_epi8(broadcast_table_avx512(byte_2_high),
+																	  _mm512_and_si512(_mm512_srli_epi16(input, 4), nibble_mask));
+				const __m512i special_cases = _mm512_and_si512(_mm512_and_si512(byte_1_high_error, byte_1_low_error), byte_2_high_error);
+
+				const __m512i must_be_continuation = _mm512_or_si512(_mm512_subs_epu8(prev2, _mm512_set1_epi8(static_cast<char>(third_byte_min))),
+																	 _mm512_subs_epu8(prev3, _mm512_set1_epi8(static_cast<char>(fourth_byte_min))));
+
+				return _mm512_xor_si512(_mm512_and_si512(must_be_continuation, _mm512_set1_epi8(static_cast<char>(0x80))), special_cases);
+			}
+			DLINK_TARGET("avx512f,avx512bw") utf8_validation_result validate_avx512(const char* data, std::size_t size) noexcept
+			{
+				const __m512i max_value = _mm512_load_si512(incomplete_max);
+
+				__m512i error = _mm512_setzero_si512();
+				__m512i prev_input = _mm512_setzero_si512();
+				__m512i prev_incomplete = _mm512_setzero_si512();
+				bool ascii = true;
+
+				std::size_t i = 0;
+
+				while (i < size)
+				{
+					__m512i input;
+
+					if (i + 64 <= size)
+					{
+						input = _mm512_loadu_si512(data + i);
+					}
+					else
+					{
+						const __mmask64 mask = (static_cast<__mmask64>(1) << (size - i)) - 1;
+						input = _mm512_mask_loadu_epi8(_mm512_set1_epi8(' '), mask, data + i);
+					}
+
+					if (_mm512_movepi8_mask(input) == 0)
+					{
+						error = _mm512_or_si512(error, prev_incomplete);
+						prev_incomplete = _mm512_setzero_si512();
+					}
+					else
+					{
+						ascii = false;
+						error = _mm512_or_si512(error, check_avx512(input, prev_input));
+						prev_incomplete = _mm512_subs_epu8(input, max_value);
+					}
+
+					prev_input = input;
+					i += 64;
+				}
+
+				error = _mm512_or_si512(error, prev_incomplete);
+
+				return { _mm512_test_epi64_mask(error, error) == 0, ascii };
+			}
+#endif
+		}
+	}
+
+	utf8_validation_result validate_utf8(const std::string_view& string) noexcept
+	{
+		using validator = utf8_validation_result(*)(const char*, std::size_t) noexcept;
+
+		static const validator function = []() -> validator
+		{
+#ifdef DLINK_X86
+			switch (get_instruction_set())
+			{
+			case instruction_set::avx512:
+				return utf8_validation::validate_avx512;
+
+			case instruction_set::avx2:
+				return utf8_validation::validate_avx2;
+
+			case instruction_set::sse42:
+				return utf8_validation::validate_sse42;
+
+			default:
+				break;
+			}
+#endif
+
+			return utf8_validation::validate_scalar;
+		}();
+
+		return function(string.data(), string.size());
+	}
+}
+
+namespace dlink
+{
+	namespace
+	{
+		namespace transcoding
+		{
+			inline std::uint16_t byte_swap(std::uint16_t unit) noexcept
+			{
+				return static_cast<std::uint16_t>((unit << 8) | (unit >> 8));
+			}
+			inline std::uint32_t byte_swap(std::uint32_t unit) noexcept
+			{
+				return ((unit & 0xFF000000) >> 24) | ((unit & 0x00FF0000) >> 8) | ((unit & 0x0000FF00) << 8) | ((unit & 0x000000FF) << 24);
+			}
+
+			template<typename Unit_>
+			inline Unit_ read_unit(const char* data, bool swap) noexcept
+			{
+				Unit_ unit;
+				std::memcpy(&unit, data, sizeof(unit));
+
+				return swap ? byte_swap(unit) : unit;
+			}
+
+			inline char* append_code_point(char* output, std::uint32_t code_point) noexcept
+			{
+				if (code_point < 0x80)
+				{
+					*output++ = static_cast<char>(code_point);
+				}
+				else if (code_point < 0x800)
+				{
+					*output++ = static_cast<char>(0xC0 | (code_point >> 6));
+					*output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+				}
+				else if (code_point < 0x10000)
+				{
+					*output++ = static_cast<char>(0xE0 | (code_point >> 12));
+					*output++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+					*output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+				}
+				else
+				{
+					*output++ = static_cast<char>(0xF0 | (code_point >> 18));
+					*output++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+					*output++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+					*output++ = static_cast<char>(0x80 | (code_point & 0x3F));
+				}
+
+				return output;
+			}
+
+			// Transcodes the UTF-16 code units in [data + i, data + end) one code point at a time. A surrogate pair
+			// may extend the range by one unit. Returns nullptr on an unpaired surrogate.
+			inline char* utf16_to_utf8_scalar(const char* data, std::size_t size, std::size_t& i, std::size_t end, bool swap,
+											  char* output) noexcept
+			{
+				while (i < end)
+				{
+					const std::uint16_t unit = read_unit<std::uint16_t>(data + i, swap);
+					i += 2;
+
+					if (unit < 0xD800 || unit > 0xDFFF)
+					{
+						output = append_code_point(output, unit);
+					}
+					else if (unit <= 0xDBFF && i < size)
+					{
+						const std::uint16_t low_unit = read_unit<std::uint16_t>(data + i, swap);
+						if (low_unit < 0xDC00 || low_unit > 0xDFFF) return nullptr;
+
+						i += 2;
+						output = append_code_point(output, 0x10000 + ((static_cast<std::uint32_t>(unit - 0xD800) << 10) | (low_unit - 0xDC00)));
+					}
+					else return nullptr;
+				}
+
+				return output;
+			}
+			inline char* utf32_to_utf8_scalar(const char* data, std::size_t& i, std::size_t end, bool swap, char* output) noexcept
+			{
+				while (i < end)
+				{
+					const std::uint32_t unit = read_unit<std::uint32_t>(data + i, swap);
+					i += 4;
+
+					if (unit > 0x10FFFF || (unit >= 0xD800 && unit <= 0xDFFF)) return nullptr;
+
+					output = append_code_point(output, unit);
+				}
+
+				return output;
+			}
+
+			char* utf16_to_utf8_generic(const char* data, std::size_t size, bool swap, char* output) noexcept
+			{
+				std::size_t i = 0;
+				return utf16_to_utf8_scalar(data, size, i, size, swap, output);
+			}
+			char* utf32_to_utf8_generic(const char* data, std::size_t size, bool swap, char* output) noexcept
+			{
+				std::size_t i = 0;
+				return utf32_to_utf8_scalar(data, i, size, swap, output);
+			}
+
+#ifdef DLINK_X86
+			// The vector loops only handle blocks that are entirely ASCII, which is what almost every line of source
+			// code is; any other block goes through the scalar path and the loop resumes right after it.
+			DLINK_TARGET("sse4.2") char* utf16_to_utf8_sse42(const char* data, std::size_t size, bool swap, char* output) noexcept
+			{
+				const __m128i swap_mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+				const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+
+				std::size_t i = 0;
+
+				while (i + 32 <= size)
+				{
+					__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+					__m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+
+					if (swap)
+					{
+						first = _mm_shuffle_epi8(first, swap_mask);
+						second = _mm_shuffle_epi8(second, swap_mask);
+					}
+
+					if (_mm_testz_si128(_mm_or_si128(first, second), non_ascii))
+					{
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(first, second));
+						output += 16;
+						i += 32;
+					}
+					else if (!(output = utf16_to_utf8_scalar(data, size, i, i + 32, swap, output))) return nullptr;
+				}
+
+				return utf16_to_utf8_scalar(data, size, i, size, swap, output);
+			}
+			DLINK_TARGET("sse4.2") char* utf32_to_utf8_sse42(const char* data, std::size_t size, bool swap, char* output) noexcept
+			{
+				const __m128i swap_mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+				const __m128i non_ascii = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+
+				std::size_t i = 0;
+
+				while (i + 64 <= size)
+				{
+					__m128i units[4];
+
+					for (int j = 0; j < 4; ++j)
+					{
+						units[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + j * 16));
+						if (swap) units[j] = _mm_shuffle_epi8(units[j], swap_mask);
+					}
+
+					if (_mm_testz_si128(_mm_or_si128(_mm_or_si128(units[0], units[1]), _mm_or_si128(units[2], units[3])), non_ascii))
+					{
+						const __m128i packed = _mm_packus_epi16(_mm_packus_epi32(units[0], units[1]), _mm_packus_epi32(units[2], units[3]));
+
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(output), packed);
+						output += 16;
+						i += 64;
+					}
+					else if (!(output = utf32_to_utf8_scalar(data, i, i + 64, swap, output))) return nullptr;
+				}
+
+				return utf32_to_utf8_scalar(data, i, size, swap, output);
+			}
+
+			DLINK_TARGET("avx2") char* utf16_to_utf8_avx2(const char* data, std::size_t size, bool swap, char* output) noexcept
+			{
+				const __m256i swap_mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+														   1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+				const __m256i non_ascii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+
+				std::size_t i = 0;
+
+				while (i + 64 <= size)
+				{
+					__m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+					__m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+
+					if (swap)
+					{
+						first = _mm256_shuffle_epi8(first, swap_mask);
+						second = _mm256_shuffle_epi8(second, swap_mask);
+					}
+
+					if (_mm256_testz_si256(_mm256_or_si256(first, second), non_ascii))
+					{
+						const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0b11011000);
+
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(output), packed);
+						output += 32;
+						i += 64;
+					}
+					else if (!(output = utf16_to_utf8_scalar(data, size, i, i + 64, swap, output))) return nullptr;
+				}
+
+				return utf16_to_utf8_scalar(data, size, i, size, swap, output);
+			}
+			DLINK_TARGET("avx2") char* utf32_to_utf8_avx2(const char* data, std::size_t size, bool swap, char* output) noexcept
+			{
+				const __m256i swap_mask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+														   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+				const __m256i non_ascii = _mm256_set1_epi32(static_cast<int>(0xFFFFFF80));
+				const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+				std::size_t i = 0;
+
+				while (i + 128 <= size)
+				{
+					__m256i units[4];
+
+					for (int j = 0; j < 4; ++j)
+					{
+						units[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + j * 32));
+						if (swap) units[j] = _mm256_shuffle_epi8(units[j], swap_mask);
+					}
+
+					if (_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(units[0], units[1]), _mm256_or_si256(units[2], units[3])), non_ascii))
+					{
+						const __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(units[0], units[1]), _mm256_packus_epi32(units[2], units[3]));
+
+						_mm256_storeu_si256(reinterpret_cast<__m256i*>(output), _mm256_permutevar8x32_epi32(packed, order));
+						output += 32;
+						i += 128;
+					}
+					else if (!(output = utf32_to_utf8_scalar(data, i, i + 128, swap, output))) return nullptr;
+				}
+
+				return utf32_to_utf8_scalar(data, i, size, swap, output);
+			}
+#endif
+
+			using transcoder = char*(*)(const char*, std::size_t, bool, char*) noexcept;
+
+			bool transcode(const std::string_view& bytes, std::size_t unit_size, endian byte_order, std::size_t max_utf8_length,
+						   transcoder function, std::string& output)
+			{
+				if (bytes.size() % unit_size != 0) return false;
+
+				const bool swap = byte_order != get_endian();
+
+				const std::size_t offset = output.size();
+				const std::size_t reserved = output.capacity();
+				output.resize(offset + bytes.size() / unit_size * max_utf8_length);
+
+				const char* const end = function(bytes.data(), bytes.size(), swap, output.data() + offset);
+				if (!end)
+				{
+					output.resize(offset);
+					return false;
+				}
+
+				output.resize(static_cast<std::size_t>(end - output.data()));
+
+				// The output grew for the longest encoding of every unit, of which ASCII text uses a third or a quarter. What it
+				// didn't use is given back, unless the caller had reserved it.
+				if (output.capacity() > reserved && output.capacity() - output.size() > output.size() / 4)
+				{
+					output.shrink_to_fit();
+				}
+
+				return true;
+			}
+		}
+	}
+
+	bool utf16_to_utf8(const std::string_view& bytes, endian byte_order, std::string& output)
+	{
+		static const transcoding::transcoder function = []() -> transcoding::transcoder
+		{
+#ifdef DLINK_X86
+			switch (get_instruction_set())
+			{
+			case instruction_set::avx512:
+			case instruction_set::avx2:
+				return transcoding::utf16_to_utf8_avx2;
+
+			case instruction_set::sse42:
+				return transcoding::utf16_to_utf8_sse42;
+
+			default:
+				break;
+			}
+#endif
+
+			return transcoding::utf16_to_utf8_generic;
+		}();
+
+		return transcoding::transcode(bytes, 2, byte_order, 3, function, output);
+	}
+	bool utf32_to_utf8(const std::string_view& bytes, endian byte_order, std::string& output)
+	{
+		static const transcoding::transcoder function = []() -> transcoding::transcoder
+		{
+#ifdef DLINK_X86
+			switch (get_instruction_set())
+			{
+			case instruction_set::avx512:
+			case instruction_set::avx2:
+				return transcoding::utf32_to_utf8_avx2;
+
+			case instruction_set::sse42:
+				return transcoding::utf32_to_utf8_sse42;
+
+			default:
+				break;
+			}
+#endif
+
+			return transcoding::utf32_to_utf8_generic;
+		}();
+
+		return transcoding::transcode(bytes, 4, byte_order, 4, function, output);
+	}
+}
+
+
+
 namespace dlink
 {
 	const std::map<std::string_view, eol> eols =
@@ -178,59 +874,6 @@ namespace dlink
 			return "";
 		}
 	}
-	bool is_eol(std::istream& stream, int& char_size)
-	{
-		char c;
-		stream.read(&c, 1);
-
-		if (!stream.good())
-			return true;
-
-		const int length = get_character_length(c);
-		char_size = length;
-
-#ifdef DLINK_LEAN_AND_MEAN
-		if (length > 1)
-#else
-		if (length == 4)
-#endif
-		{
-			stream.seekg(-1, std::ios::cur);
-			return false;
-		}
-
-#ifndef DLINK_LEAN_AND_MEAN
-		if (length == 1)
-		{
-#endif
-			if (eols.find(std::string_view(&c, 1)) != eols.end())
-			{
-				stream.read(&c, 1);
-
-				if (c != '\u000A')
-				{
-					stream.seekg(-1, std::ios::cur);
-				}
-
-				return true;
-			}
-#ifndef DLINK_LEAN_AND_MEAN
-		}
-		else
-		{
-			char c_array[3] = { c, 0, 0 };
-			stream.read(c_array + 1, length - 1);
-
-			if (eols.find(std::string_view(c_array, length)) != eols.end())
-			{
-				return true;
-			}
-		}
-#endif
-
-		stream.seekg(-length, std::ios::cur);
-		return false;
-	}
 }
 
 namespace dlink
@@ -360,79 +1003,90 @@ namespace dlink
 			return "";
 		}
 	}
-	bool is_whitespace(std::istream& stream)
+	std::size_t match_unicode_whitespace(const char* current, const char* end, whitespace& type, bool& is_eol) noexcept
 	{
-		char dummy_output;
-		whitespace dummy_type;
+		// A small DFA over the bytes of the multi-byte whitespaces. Every one of them starts with C2, E1, E2 or E3.
+		const std::size_t size = static_cast<std::size_t>(end - current);
+		const auto byte = [current](std::size_t index) noexcept
+		{
+			return static_cast<unsigned char>(current[index]);
+		};
 
-		const bool result = is_whitespace(stream, dummy_output, dummy_type);
-		if (result) return true;
+		is_eol = false;
 
-		const int dummy_output_size = get_character_length(dummy_output);
-		stream.seekg(dummy_output_size);
+		switch (byte(0))
+		{
+#ifndef DLINK_LEAN_AND_MEAN
+		case 0xC2:
+			if (size < 2) return 0;
 
-		return false;
-	}
-	bool is_whitespace(std::istream& stream, char& output)
-	{
-		whitespace dummy;
-		return is_whitespace(stream, output, dummy);
-	}
-	bool is_whitespace(std::istream& stream, char& output, whitespace& type)
-	{
-		char c;
-		stream.read(&c, 1);
-		if (!stream.good()) return true;
+			if (byte(1) == 0x85)
+			{
+				type = whitespace::next_line;
+				is_eol = true;
+				return 2;
+			}
+			else if (byte(1) == 0xA0)
+			{
+				type = whitespace::no_break_space;
+				return 2;
+			}
 
-		const int length = get_character_length(c);
-		output = c;
+			return 0;
 
-		if (length == 4)
-		{
-			output = c;
-			stream.seekg(3, std::ios::cur);
-			return false;
-		}
-		
-		if (length == 1)
-		{
-			if (std::map<std::string_view, whitespace>::const_iterator iter = whitespaces.find(std::string_view(&c, 1));
-				iter != whitespaces.end())
-			{
-				type = iter->second;
+		case 0xE1:
+			if (size < 3 || byte(1) != 0x9A || byte(2) != 0x80) return 0;
+
+			type = whitespace::ogham_space_mark;
+			return 3;
 
-				const char prev_c = c;
+		case 0xE2:
+			if (size < 3) return 0;
 
-				stream.read(&c, 1);
-				if (!stream.good()) return true;
+			if (byte(1) == 0x80)
+			{
+				static constexpr whitespace spaces[] =
+				{
+					whitespace::en_quad, whitespace::em_quad, whitespace::en_space, whitespace::em_space,
+					whitespace::three_per_em_space, whitespace::four_per_em_space, whitespace::six_per_em_space,
+					whitespace::figure_space, whitespace::punctuation_space, whitespace::thin_space, whitespace::hair_space,
+				};
 
-				if (prev_c == '\u000D' && c == '\u000A')
+				if (byte(2) >= 0x80 && byte(2) <= 0x8A)
 				{
-					type = whitespace::carriage_return_line_feed;
+					type = spaces[byte(2) - 0x80];
+					return 3;
 				}
-				else
+				else if (byte(2) == 0xA8 || byte(2) == 0xA9)
 				{
-					stream.seekg(-1, std::ios::cur);
+					type = byte(2) == 0xA8 ? whitespace::line_separator : whitespace::paragraph_separator;
+					is_eol = true;
+					return 3;
+				}
+				else if (byte(2) == 0xAF)
+				{
+					type = whitespace::narrow_no_break_space;
+					return 3;
 				}
-
-				return true;
 			}
-		}
-		else
-		{
-			char c_array[3] = { c, 0, 0 };
-			stream.read(c_array + 1, length - 1);
-
-			if (std::map<std::string_view, whitespace>::const_iterator iter = whitespaces.find(std::string_view(c_array, length));
-				iter != whitespaces.end())
+			else if (byte(1) == 0x81 && byte(2) == 0x9F)
 			{
-				type = iter->second;
-				return true;
+				type = whitespace::medium_mathematical_space;
+				return 3;
 			}
-		}
 
-		output = c;
-		return false;
+			return 0;
+#endif
+
+		case 0xE3:
+			if (size < 3 || byte(1) != 0x80 || byte(2) != 0x80) return 0;
+
+			type = whitespace::ideographic_space;
+			return 3;
+
+		default:
+			return 0;
+		}
 	}
 	std::pair<std::string, std::vector<std::pair<std::size_t, std::size_t>>> replace_with_space(const std::string_view& string)
 	{
@@ -463,23 +1117,37 @@ namespace dlink
 		std::string result;
 		std::vector<std::pair<std::size_t, std::size_t>> replaced_pos;
 
-		boost::iostreams::stream<boost::iostreams::basic_array_source<char>> stream(string.data(), string.size());
+		const char* current = string.data();
+		const char* const end = current + string.size();
+		bool eof = false;
 
 		std::size_t offset = 0;
 		std::size_t length = 0;
+		char c = 0;
 
-		while (!stream.eof())
+		while (!eof)
 		{
-			char c;
 			whitespace whitespace_type;
-			
-			if (is_whitespace(stream, c, whitespace_type))
+			std::size_t whitespace_size = 0;
+
+			// A single-byte whitespace at the end is treated like the end itself.
+			if (current == end || ((whitespace_size = match_whitespace(current, end, whitespace_type)) == 1 && current + 1 == end))
+			{
+				eof = true;
+			}
+			else
+			{
+				c = *current;
+				current += whitespace_size ? whitespace_size : get_character_length_unchecked(c);
+			}
+
+			if (eof || whitespace_size)
 			{
 				result += string.substr(offset, length);
 				offset += length;
 				length = 0;
 
-				if (stream.eof()) break;
+				if (eof) break;
 
 				if (const std::map<whitespace, std::string_view>::const_iterator iter = map.find(whitespace_type);
 					iter != map.end())
@@ -489,14 +1157,14 @@ namespace dlink
 				}
 				else
 				{
-					result += string.substr(offset, get_character_length(c));
+					result += string.substr(offset, get_character_length_unchecked(c));
 				}
 
-				offset += get_character_length(c);
+				offset += get_character_length_unchecked(c);
 			}
 			else
 			{
-				length += get_character_length(c);
+				length += get_character_length_unchecked(c);
 			}
 		}
 
@@ -513,4 +1181,209 @@ namespace dlink
 		if (static_cast<unsigned char>(c) > 0x7F) return false;
 		else return std::isalpha(c);
 	}
+}
+
+namespace dlink
+{
+	namespace
+	{
+		namespace run_scanning
+		{
+			inline int count_trailing_zeros(std::uint32_t mask) noexcept
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, mask);
+
+				return static_cast<int>(index);
+#else
+				return __builtin_ctz(mask);
+#endif
+			}
+
+			inline bool is_word(char c) noexcept
+			{
+				const unsigned char u = static_cast<unsigned char>(c);
+				return static_cast<unsigned char>(u - '0') < 10 || static_cast<unsigned char>((u | 0x20) - 'a') < 26 || u == '_';
+			}
+			inline bool is_blank(char c) noexcept
+			{
+				return c == ' ' || c == '\t';
+			}
+
+			std::size_t word_run_scalar(const char* current, const char* end) noexcept
+			{
+				const char* const begin = current;
+				while (current != end && is_word(*current)) ++current;
+
+				return static_cast<std::size_t>(current - begin);
+			}
+			std::size_t blank_run_scalar(const char* current, const char* end) noexcept
+			{
+				const char* const begin = current;
+				while (current != end && is_blank(*current)) ++current;
+
+				return static_cast<std::size_t>(current - begin);
+			}
+
+#ifdef DLINK_X86
+			// SSE2 has no unsigned comparison, so 'lo <= c < lo + count' is checked as a signed comparison after
+			// moving 'lo' to the lowest signed value.
+			inline __m128i in_range_sse2(__m128i input, char lo, char count) noexcept
+			{
+				const __m128i biased = _mm_add_epi8(input, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+				return _mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(0x80 + count)));
+			}
+			inline std::uint32_t words_sse2(__m128i input) noexcept
+			{
+				__m128i result = in_range_sse2(input, '0', 10);
+				result = _mm_or_si128(result, in_range_sse2(_mm_or_si128(input, _mm_set1_epi8(0x20)), 'a', 26));
+				result = _mm_or_si128(result, _mm_cmpeq_epi8(input, _mm_set1_epi8('_')));
+
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(result));
+			}
+			inline std::uint32_t blanks_sse2(__m128i input) noexcept
+			{
+				const __m128i result = _mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8(' ')),
+													_mm_cmpeq_epi8(input, _mm_set1_epi8('\t')));
+
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(result));
+			}
+			template<std::uint32_t(*Matches)(__m128i) noexcept, std::size_t(*Scalar)(const char*, const char*) noexcept>
+			std::size_t run_sse2(const char* current, const char* end) noexcept
+			{
+				const char* const begin = current;
+
+				while (end - current >= 16)
+				{
+					const std::uint32_t mismatches = ~Matches(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current))) & 0xFFFF;
+					if (mismatches) return static_cast<std::size_t>(current - begin) + count_trailing_zeros(mismatches);
+
+					current += 16;
+				}
+
+				return static_cast<std::size_t>(current - begin) + Scalar(current, end);
+			}
+
+			DLINK_TARGET("avx2") inline __m256i in_range_avx2(__m256i input, char lo, char count) noexcept
+			{
+				const __m256i biased = _mm256_add_epi8(input, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+				return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + count)), biased);
+			}
+			DLINK_TARGET("avx2") inline std::uint32_t words_avx2(__m256i input) noexcept
+			{
+				__m256i result = in_range_avx2(input, '0', 10);
+				result = _mm256_or_si256(result, in_range_avx2(_mm256_or_si256(input, _mm256_set1_epi8(0x20)), 'a', 26));
+				result = _mm256_or_si256(result, _mm256_cmpeq_epi8(input, _mm256_set1_epi8('_')));
+
+				return static_cast<std::uint32_t>(_mm256_movemask_epi8(result));
+			}
+			DLINK_TARGET("avx2") inline std::uint32_t blanks_avx2(__m256i input) noexcept
+			{
+				const __m256i result = _mm256_or_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8(' ')),
+													   _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\t')));
+
+				return static_cast<std::uint32_t>(_mm256_movemask_epi8(result));
+			}
+
+			// Identifiers and blank runs are mostly short, so the first block is checked with SSE2 before going wide.
+			DLINK_TARGET("avx2") std::size_t word_run_avx2(const char* current, const char* end) noexcept
+			{
+				const char* const begin = current;
+
+				if (end - current >= 16)
+				{
+					const std::uint32_t mismatches = ~words_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current))) & 0xFFFF;
+					if (mismatches) return count_trailing_zeros(mismatches);
+
+					current += 16;
+				}
+				while (end - current >= 32)
+				{
+					const std::uint32_t mismatches = ~words_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(current)));
+					if (mismatches) return static_cast<std::size_t>(current - begin) + count_trailing_zeros(mismatches);
+
+					current += 32;
+				}
+
+				return static_cast<std::size_t>(current - begin) + run_sse2<words_sse2, word_run_scalar>(current, end);
+			}
+			DLINK_TARGET("avx2") std::size_t blank_run_avx2(const char* current, const char* end) noexcept
+			{
+				const char* const begin = current;
+
+				if (end - current >= 16)
+				{
+					const std::uint32_t mismatches = ~blanks_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current))) & 0xFFFF;
+					if (mismatches) return count_trailing_zeros(mismatches);
+
+					current += 16;
+				}
+				while (end - current >= 32)
+				{
+					const std::uint32_t mismatches = ~blanks_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(current)));
+					if (mismatches) return static_cast<std::size_t>(current - begin) + count_trailing_zeros(mismatches);
+
+					current += 32;
+				}
+
+				return static_cast<std::size_t>(current - begin) + run_sse2<blanks_sse2, blank_run_scalar>(current, end);
+			}
+#endif
+		}
+	}
+
+	std::size_t match_word_run(const char* current, const char* end) noexcept
+	{
+		using scanner = std::size_t(*)(const char*, const char*) noexcept;
+
+		static const scanner function = []() -> scanner
+		{
+#ifdef DLINK_X86
+			// SSE2 is implied by every instruction set get_instruction_set reports.
+			switch (get_instruction_set())
+			{
+			case instruction_set::avx512:
+			case instruction_set::avx2:
+				return run_scanning::word_run_avx2;
+
+			case instruction_set::sse42:
+				return run_scanning::run_sse2<run_scanning::words_sse2, run_scanning::word_run_scalar>;
+
+			default:
+				break;
+			}
+#endif
+
+			return run_scanning::word_run_scalar;
+		}();
+
+		return function(current, end);
+	}
+	std::size_t match_blank_run(const char* current, const char* end) noexcept
+	{
+		using scanner = std::size_t(*)(const char*, const char*) noexcept;
+
+		static const scanner function = []() -> scanner
+		{
+#ifdef DLINK_X86
+			switch (get_instruction_set())
+			{
+			case instruction_set::avx512:
+			case instruction_set::avx2:
+				return run_scanning::blank_run_avx2;
+
+			case instruction_set::sse42:
+				return run_scanning::run_sse2<run_scanning::blanks_sse2, run_scanning::blank_run_scalar>;
+
+			default:
+				break;
+			}
+#endif
+
+			return run_scanning::blank_run_scalar;
+		}();
+
+		return function(current, end);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include <Dlink/interner.hpp>
+
+#include <Dlink/system.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace dlink
+{
+	namespace
+	{
+		namespace interning
+		{
+			constexpr std::size_t initial_capacity = 256;
+			constexpr std::size_t min_block_size = 64 * 1024;
+		}
+	}
+
+	interner::table_::table_(std::size_t capacity)
+		: mask(capacity - 1), slots(new std::atomic<std::uint64_t>[capacity])
+	{
+		for (std::size_t i = 0; i < capacity; ++i)
+		{
+			slots[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	interner::interner()
+	{
+		for (shard_& shard : shards_)
+		{
+			shard.tables.push_back(std::make_unique<table_>(interning::initial_capacity));
+			shard.table.store(shard.tables.back().get(), std::memory_order_relaxed);
+		}
+		for (std::atomic<std::string_view*>& segment : segments_)
+		{
+			segment.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+	interner::~interner()
+	{
+		for (std::atomic<std::string_view*>& segment : segments_)
+		{
+			delete[] segment.load(std::memory_order_relaxed);
+		}
+	}
+
+	symbol interner::intern(const std::string_view& string)
+	{
+		const std::uint64_t hash = std::hash<std::string_view>()(string);
+		// The upper half of the hash picks the shard, and the lower half the slot and the tag.
+		shard_& shard = shards_[static_cast<std::size_t>(((hash >> 32) * shards_.size()) >> 32)];
+
+		if (const symbol found = find_(*shard.table.load(std::memory_order_acquire), hash, string); found != invalid_symbol)
+			return found;
+
+		return insert_(shard, hash, string);
+	}
+	std::string_view interner::string(symbol symbol) const noexcept
+	{
+		const std::uint64_t position = static_cast<std::uint64_t>(symbol) + (std::uint64_t(1) << first_segment_bits_);
+		const int segment = bit_width(position) - 1 - static_cast<int>(first_segment_bits_);
+
+		return segments_[segment].load(std::memory_order_acquire)[position - (std::uint64_t(1) << (segment + first_segment_bits_))];
+	}
+	std::size_t interner::size() const noexcept
+	{
+		return next_symbol_.load(std::memory_order_acquire);
+	}
+
+	void interner::add_lookups(std::size_t count) noexcept
+	{
+		lookups_.fetch_add(count, std::memory_order_relaxed);
+	}
+	interner_statistics interner::statistics() const noexcept
+	{
+		interner_statistics result{};
+
+		result.symbols = size();
+		result.lookups = lookups_.load(std::memory_order_relaxed);
+		result.hits = result.lookups > result.symbols ? result.lookups - result.symbols : 0;
+
+		for (const shard_& shard : shards_)
+		{
+			result.contentions += shard.contentions.load(std::memory_order_relaxed);
+		}
+
+		return result;
+	}
+
+	symbol interner::find_(const table_& table, std::uint64_t hash, const std::string_view& string) const noexcept
+	{
+		const std::uint64_t tag = hash & 0xFFFFFFFF;
+
+		for (std::size_t i = static_cast<std::size_t>(hash) & table.mask;; i = (i + 1) & table.mask)
+		{
+			const std::uint64_t slot = table.slots[i].load(std::memory_order_acquire);
+			if (slot == 0) return invalid_symbol;
+
+			if ((slot >> 32) == tag)
+			{
+				const symbol candidate = static_cast<symbol>(slot & 0xFFFFFFFF) - 1;
+				if (this->string(candidate) == string) return candidate;
+			}
+		}
+	}
+	symbol interner::insert_(shard_& shard, std::uint64_t hash, const std::string_view& string)
+	{
+#ifdef DLINK_MULTITHREADING
+		std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+
+		if (!lock.owns_lock())
+		{
+			shard.contentions.fetch_add(1, std::memory_order_relaxed);
+			lock.lock();
+		}
+#endif
+
+		table_* table = shard.table.load(std::memory_order_relaxed);
+
+		// Another thread may have inserted the string while this one was waiting.
+		if (const symbol found = find_(*table, hash, string); found != invalid_symbol)
+			return found;
+
+		// Tables are kept at most half full, so probes stay short and always end at an empty slot.
+		if ((shard.size + 1) * 2 > table->mask + 1)
+		{
+			std::unique_ptr<table_> new_table = std::make_unique<table_>((table->mask + 1) * 2);
+
+			for (std::size_t i = 0; i <= table->mask; ++i)
+			{
+				const std::uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+				if (slot == 0) continue;
+
+				std::size_t j = static_cast<std::size_t>(slot >> 32) & new_table->mask;
+				while (new_table->slots[j].load(std::memory_order_relaxed) != 0)
+				{
+					j = (j + 1) & new_table->mask;
+				}
+
+				new_table->slots[j].store(slot, std::memory_order_relaxed);
+			}
+
+			// Old tables stay alive, as readers that loaded them before this store may still be probing them.
+			table = new_table.get();
+			shard.tables.push_back(std::move(new_table));
+			shard.table.store(table, std::memory_order_release);
+		}
+
+		const symbol result = next_symbol_.fetch_add(1, std::memory_order_relaxed);
+		publish_(result, store_(shard, string));
+
+		std::size_t i = static_cast<std::size_t>(hash) & table->mask;
+		while (table->slots[i].load(std::memory_order_relaxed) != 0)
+		{
+			i = (i + 1) & table->mask;
+		}
+
+		table->slots[i].store(((hash & 0xFFFFFFFF) << 32) | (static_cast<std::uint64_t>(result) + 1), std::memory_order_release);
+		++shard.size;
+
+		return result;
+	}
+	std::string_view interner::store_(shard_& shard, const std::string_view& string)
+	{
+		if (string.empty()) return std::string_view();
+
+		if (shard.blocks.empty() || shard.block_size - shard.block_used < string.size())
+		{
+			shard.block_size = std::max(interning::min_block_size, string.size());
+			shard.block_used = 0;
+			shard.blocks.push_back(std::make_unique<char[]>(shard.block_size));
+		}
+
+		char* const data = shard.blocks.back().get() + shard.block_used;
+		std::memcpy(data, string.data(), string.size());
+		shard.block_used += string.size();
+
+		return std::string_view(data, string.size());
+	}
+	void interner::publish_(symbol symbol, const std::string_view& string)
+	{
+		const std::uint64_t position = static_cast<std::uint64_t>(symbol) + (std::uint64_t(1) << first_segment_bits_);
+		const int segment_index = bit_width(position) - 1 - static_cast<int>(first_segment_bits_);
+		std::atomic<std::string_view*>& segment = segments_[segment_index];
+
+		std::string_view* segment_data = segment.load(std::memory_order_acquire);
+
+		// Shards insert concurrently, so the first one to need a segment allocates it and the others use that one.
+		if (!segment_data)
+		{
+			std::string_view* const new_segment = new std::string_view[std::size_t(1) << (segment_index + first_segment_bits_)];
+
+			if (segment.compare_exchange_strong(segment_data, new_segment, std::memory_order_acq_rel))
+			{
+				segment_data = new_segment;
+			}
+			else
+			{
+				delete[] new_segment;
+			}
+		}
+
+		// The release store of the slot that follows makes this visible to the readers that find the symbol.
+		segment_data[position - (std::uint64_t(1) << (segment_index + first_segment_bits_))] = string;
+	}
+}
\ No newline at end of file
@@ -1,113 +1,99 @@
 #include <Dlink/lexer.hpp>
 
+#include <Dlink/decoder.hpp>
 #include <Dlink/encoding.hpp>
 #include <Dlink/exception.hpp>
-#include <Dlink/utility.hpp>
+#include <Dlink/preprocessor.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
 
-#include <boost/iostreams/stream.hpp>
-#include <boost/iostreams/device/array.hpp>
-
 #ifdef DLINK_MULTITHREADING
 #	include <Dlink/threading.hpp>
 #endif
 
-namespace dlink
+namespace dlink::details
 {
-#define MAP_KEYWORD(keyword) MAP_KEYWORD_INTERNAL(keyword, keyword_) 
-#define MAP_KEYWORD_INTERNAL(keyword, dummy) std::pair<std::string_view, token_type>(#keyword , token_type:: dummy##keyword)
-	const std::map<std::string_view, token_type> keywords =
+	struct keyword_slot final
 	{
-		MAP_KEYWORD(auto),
-		MAP_KEYWORD(void),
-		MAP_KEYWORD(bool),
-		MAP_KEYWORD(char),
-		MAP_KEYWORD(char16),
-		MAP_KEYWORD(char32),
-
-		MAP_KEYWORD(i8),
-		MAP_KEYWORD(i16),
-		MAP_KEYWORD(i32),
-		MAP_KEYWORD(i64),
-		MAP_KEYWORD(u8),
-		MAP_KEYWORD(u16),
-		MAP_KEYWORD(u32),
-		MAP_KEYWORD(u64),
-
-		MAP_KEYWORD(let),
-		MAP_KEYWORD(immut),
-		MAP_KEYWORD(mut),
-		MAP_KEYWORD(const),
-
-		MAP_KEYWORD(func),
-		MAP_KEYWORD(class),
-		MAP_KEYWORD(union),
-		MAP_KEYWORD(module),
-		MAP_KEYWORD(domain),
-		MAP_KEYWORD(inline),
-		MAP_KEYWORD(enum),
-		MAP_KEYWORD(public),
-		MAP_KEYWORD(internal),
-		MAP_KEYWORD(protected),
-		MAP_KEYWORD(private),
-		MAP_KEYWORD(use),
-		MAP_KEYWORD(as),
-		MAP_KEYWORD(default),
-		MAP_KEYWORD(macro),
-		MAP_KEYWORD(panic),
-
-		MAP_KEYWORD(for),
-		MAP_KEYWORD(do),
-		MAP_KEYWORD(while),
-		MAP_KEYWORD(match),
-		MAP_KEYWORD(if),
-		MAP_KEYWORD(else),
-		MAP_KEYWORD(goto),
-		MAP_KEYWORD(break),
-		MAP_KEYWORD(continue),
-		MAP_KEYWORD(return),
-
-		MAP_KEYWORD(extern),
-		MAP_KEYWORD(template),
-		MAP_KEYWORD(type),
-		MAP_KEYWORD(concept),
-		MAP_KEYWORD(unsafe),
-
-		MAP_KEYWORD(virtual),
-		MAP_KEYWORD(abstract),
-		MAP_KEYWORD(open),
-		MAP_KEYWORD(this),
-		MAP_KEYWORD(super),
-		MAP_KEYWORD(static),
-
-		MAP_KEYWORD(async),
-		MAP_KEYWORD(await),
-
-		MAP_KEYWORD(bit),
-		MAP_KEYWORD(new),
-		MAP_KEYWORD(delete),
-		MAP_KEYWORD(nullptr),
-
-		MAP_KEYWORD(static_cast),
-		MAP_KEYWORD(dynamic_cast),
-		MAP_KEYWORD(const_cast),
-		MAP_KEYWORD(reinterpret_cast),
-		MAP_KEYWORD(is),
-		MAP_KEYWORD(typeid),
-
-		MAP_KEYWORD(static_assert),
-
-		MAP_KEYWORD(true),
-		MAP_KEYWORD(false),
+		std::string_view name;
+		token_type type = token_type::none;
 	};
-#undef MAP_KEYWORD
-#undef MAP_KEYWORD_INTERNAL
+
+	constexpr std::size_t keyword_size_bound(bool max) noexcept
+	{
+		std::size_t result = keywords[0].first.size();
+
+		for (const std::pair<std::string_view, token_type>& keyword : keywords)
+		{
+			const std::size_t size = keyword.first.size();
+			result = max ? (size > result ? size : result) : (size < result ? size : result);
+		}
+
+		return result;
+	}
+
+	static constexpr std::size_t keyword_min_size = keyword_size_bound(false);
+	static constexpr std::size_t keyword_max_size = keyword_size_bound(true);
+	static_assert(keyword_min_size >= 2);
+
+	// The length and the first, second and last characters tell every keyword apart; the factors were searched so that no two keywords share a slot.
+	constexpr std::size_t keyword_hash(const std::string_view& string) noexcept
+	{
+		return (string.size() +
+				static_cast<unsigned char>(string[0]) +
+				static_cast<unsigned char>(string[1]) * 12 +
+				static_cast<unsigned char>(string.back()) * 18) & 0xFF;
+	}
+
+	constexpr std::array<keyword_slot, 256> make_keyword_table() noexcept
+	{
+		std::array<keyword_slot, 256> result{};
+
+		for (const std::pair<std::string_view, token_type>& keyword : keywords)
+		{
+			keyword_slot& slot = result[keyword_hash(keyword.first)];
+			slot.name = keyword.first;
+			slot.type = keyword.second;
+		}
+
+		return result;
+	}
+
+	static constexpr std::array<keyword_slot, 256> keyword_table = make_keyword_table();
+
+	constexpr bool is_keyword_table_perfect() noexcept
+	{
+		for (const std::pair<std::string_view, token_type>& keyword : keywords)
+		{
+			if (keyword_table[keyword_hash(keyword.first)].name != keyword.first) return false;
+		}
+
+		return true;
+	}
+
+	static_assert(is_keyword_table_perfect(), "Two keywords share a slot of the keyword table; the factors of keyword_hash need to be searched again.");
+}
+
+namespace dlink
+{
+	token_type find_keyword(const std::string_view& string) noexcept
+	{
+		if (string.size() < details::keyword_min_size || string.size() > details::keyword_max_size)
+			return token_type::none;
+
+		const details::keyword_slot& slot = details::keyword_table[details::keyword_hash(string)];
+		return slot.name == string ? slot.type : token_type::none;
+	}
 }
 
 namespace dlink
@@ -127,7 +113,7 @@ namespace dlink
 			return result;
 		};
 
-		return parallel(lex_multithread, get_threading_info(metadata));
+		return parallel(lex_multithread, get_threading_info(metadata, sources), metadata, "lex");
 #else
 		return lex_singlethread(metadata, sources);
 #endif
@@ -143,371 +129,1068 @@ namespace dlink
 
 		return result;
 	}
+	bool lexer::lex_fused(compiler_metadata& metadata, std::vector<source>& sources)
+	{
+#ifdef DLINK_MULTITHREADING
+		auto lex_multithread = [&](std::size_t begin, std::size_t end) -> bool
+		{
+			bool result = true;
+
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				result = lex_source_fused(sources[i], metadata) && result;
+			}
+
+			return result;
+		};
+
+		return parallel(lex_multithread, get_threading_info(metadata, sources), metadata, "lex_fused");
+#else
+		return lex_fused_singlethread(metadata, sources);
+#endif
+	}
+	bool lexer::lex_fused_singlethread(compiler_metadata& metadata, std::vector<source>& sources)
+	{
+		bool result = true;
+
+		for (source& src : sources)
+		{
+			result = lex_source_fused(src, metadata) && result;
+		}
+
+		return result;
+	}
 	bool lexer::lex_source(source& source, compiler_metadata& metadata)
 	{
 		if (source.state() < source_state::preprocessed)
 			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::preprocessed' or higher when 'static bool dlink::lexer::lex_source(dlink::source&, dlink::compiler_metadata&)' method is called.");
 		
+		if (!check_size_(source, metadata.messages(), source.codes().size())) return false;
+
 		std::vector<token> tokens;
-		if (!lex_preprocess_(source, metadata, tokens)) return false;
+		std::vector<std::size_t> comment_lines;
+		bool lexed;
+
+#ifdef DLINK_MULTITHREADING
+		if (const std::size_t chunk_size = metadata.options().lex_chunk_size(); chunk_size != 0 && source.codes().size() > chunk_size)
+		{
+			lexed = lex_preprocess_parallel_(source, metadata, tokens, comment_lines, chunk_size);
+		}
+		else
+#endif
+		{
+			lexed = lex_preprocess_(source, metadata.messages(), tokens, comment_lines);
+		}
+
+		token_buffer buffer;
+		if (!lexed || !lex_tokens_(source, metadata, tokens, buffer)) return false;
+
+		buffer.comment_lines(std::move(comment_lines));
+		source.tokens(std::move(buffer));
+		return true;
+	}
+	bool lexer::lex_source_fused(source& source, compiler_metadata& metadata)
+	{
+		if (source.state() < source_state::decoded)
+			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::decoded' or higher when 'static bool dlink::lexer::lex_source_fused(dlink::source&, dlink::compiler_metadata&)' method is called.");
+
+		const std::string_view codes = source.codes();
+		const line_index& lines = source.lines();
+		if (!check_size_(source, metadata.messages(), codes.size())) return false;
 
+		// Diagnostics of the lexer are held back until every directive has been seen, as lex_source would only run after preprocess_source.
+		dlink::messages messages;
+		std::vector<preprocessed_line> preprocessed_codes;
+		std::vector<token> tokens;
 		bool ok = true;
+		line_lexing_state_ state;
 
-		for (std::size_t i = 0; i < tokens.size(); ++i)
+		for (std::size_t line = 1; line <= lines.count(); ++line)
 		{
-			token& cur_token = tokens[i];
-			const token_type cur_token_type = cur_token.type();
+			const std::string_view current_line = lines.line_data(codes, line);
+			if (current_line.empty()) break;
 
-			if (cur_token_type == token_type::none_hm)
+			if (preprocessor::preprocess_line_(source, metadata.messages(), current_line, line, ok))
 			{
-#define make_internal_lexing_data() (internal_lexing_data_{ source, metadata, tokens, cur_token, i })
+				preprocessed_codes.push_back({ current_line, line });
+				lex_line_(source, messages, current_line, line, lines.line_begin(line), state, tokens);
+			}
+		}
 
-				const char first_c = cur_token.data()[0];
+		if (!ok) return false;
 
-				if (isdigit(first_c))
-				{
-					ok = lex_number_(make_internal_lexing_data()) && ok;
-				}
-				else
-				{
-					const std::map<std::string_view, token_type>::const_iterator iter =
-						keywords.find(cur_token.data());
+		source.preprocessed_codes(std::move(preprocessed_codes));
 
-					if (iter != keywords.end())
-					{
-						cur_token.type(iter->second);
-					}
-					else
+		const bool lexed = lex_end_(source, messages, state);
+
+		for (message_ptr& message : messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+
+		token_buffer buffer;
+		if (!lexed || !lex_tokens_(source, metadata, tokens, buffer)) return false;
+
+		buffer.comment_lines(std::move(state.comment_lines));
+		source.tokens(std::move(buffer));
+		return true;
+	}
+
+	bool lexer::lex_source_streaming(source& source, compiler_metadata& metadata, std::size_t chunk_size)
+	{
+		if (source.state() < source_state::initialized)
+			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::initialized' or higher when 'static bool dlink::lexer::lex_source_streaming(dlink::source&, dlink::compiler_metadata&, std::size_t)' method is called.");
+
+		decoding_stream stream(source, metadata, chunk_size);
+		if (!stream.is_open())
+			return decoder::decode_source(source, metadata) && preprocessor::preprocess_source(source, metadata) && lex_source(source, metadata);
+
+		// Diagnostics are held back and published in the order lex_source would publish them.
+		dlink::messages preprocessing_messages;
+		dlink::messages line_messages;
+		dlink::messages token_messages;
+		dlink::messages number_messages;
+		std::vector<preprocessed_line> preprocessed_codes;
+		bool ok = true;
+		bool tokens_ok = true;
+		bool stopped = false;
+		line_lexing_state_ state;
+
+		// Only the raw tokens that aren't final yet are kept: the first 'kept' of them have been visited, and the rest haven't.
+		std::vector<token> tokens;
+		std::size_t kept = 0;
+		std::size_t identifiers = 0;
+		token_buffer buffer;
+
+		// A token can merge up to two raw tokens after it, and the last kept one can still be extended by the token after it,
+		// so tokens are visited only while two more follow them, and every kept token but the last is final.
+		const auto lex_tokens = [&](bool finished)
+		{
+			std::size_t i = kept;
+
+			while (i < tokens.size() && (finished || tokens.size() - i >= 3))
+			{
+				const std::size_t cur_index = i;
+
+				if (lex_token_(source, token_messages, tokens, i, kept ? &tokens[kept - 1] : nullptr, tokens_ok))
+				{
+					if (kept != cur_index)
 					{
-						cur_token.type(token_type::identifier);
+						tokens[kept] = tokens[cur_index];
 					}
+
+					++kept;
 				}
 
-#undef make_internal_lexing_data
+				++i;
 			}
-			else if (cur_token_type == token_type::dot)
+
+			const std::size_t final_count = finished || kept == 0 ? kept : kept - 1;
+
+			for (std::size_t j = 0; j < final_count; ++j)
 			{
-				if (i == 0) continue;
-				else if (i + 1 >= tokens.size()) continue;
+				identifiers += push_token_(source, metadata, number_messages, tokens[j], buffer, tokens_ok);
+			}
+
+			tokens.erase(tokens.begin() + kept, tokens.begin() + i);
+			tokens.erase(tokens.begin(), tokens.begin() + final_count);
+			kept -= final_count;
+		};
 
-				token& prev_token = tokens[i - 1];
-				token& next_token = tokens[i + 1];
+		while (!stream.eof())
+		{
+			const std::size_t first_line = source.lines().count();
+			if (!stream.read())
+				return false;
 
-				if (prev_token.type() != token_type::integer_dec) continue;
-				else if (next_token.type() != token_type::none_hm)
+			// Transcoded codes grow with every chunk, so the buffer is pointed at all of them again.
+			const std::string_view codes = source.codes();
+			const line_index& lines = source.lines();
+			if (!check_size_(source, metadata.messages(), codes.size()))
+				return false;
+
+			buffer.codes(codes);
+
+			for (std::size_t line = first_line + 1; line <= lines.count() && !stopped; ++line)
+			{
+				const std::string_view current_line = lines.line_data(codes, line);
+				if (current_line.empty())
 				{
-					prev_token.type(token_type::decimal);
-					prev_token.data(std::string_view(prev_token.data().data(), prev_token.data().size() + 1));
-					tokens.erase(tokens.begin() + i--);
+					stopped = true;
+					break;
+				}
 
-					continue;
+				if (preprocessor::preprocess_line_(source, preprocessing_messages, current_line, line, ok))
+				{
+					preprocessed_codes.push_back({ current_line, line });
+					lex_line_(source, line_messages, current_line, line, lines.line_begin(line), state, tokens);
 				}
+			}
+
+			// Nothing is lexed further once a line failed, as lex_source wouldn't run at all. The identifiers of the chunks
+			// lexed before stay interned, which does no harm, as a symbol is only a name.
+			if (ok && state.ok)
+			{
+				lex_tokens(false);
+			}
+		}
+
+		for (message_ptr& message : preprocessing_messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+		if (!ok) return false;
+
+		source.preprocessed_codes(std::move(preprocessed_codes));
+
+		const bool lexed = lex_end_(source, line_messages, state);
+
+		for (message_ptr& message : line_messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+		if (!lexed) return false;
+
+		lex_tokens(true);
+
+		for (message_ptr& message : token_messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+		for (message_ptr& message : number_messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+
+		metadata.interner().add_lookups(identifiers);
+		if (!tokens_ok) return false;
+
+		buffer.comment_lines(std::move(state.comment_lines));
+		source.tokens(std::move(buffer));
+		return true;
+	}
+
+	bool lexer::relex_source(source& source, compiler_metadata& metadata, const source_edit& edit)
+	{
+		if (source.state() < source_state::lexed)
+			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::lexed' when 'static bool dlink::lexer::relex_source(dlink::source&, dlink::compiler_metadata&, const dlink::source_edit&)' method is called.");
+
+		const std::string_view old_codes = source.codes();
+		if (edit.offset > old_codes.size() || edit.length > old_codes.size() - edit.offset)
+			throw std::out_of_range("The range of the argument 'edit' must be in the codes of the argument 'source'.");
+
+		std::string new_codes;
+		new_codes.reserve(old_codes.size() - edit.length + edit.replacement.size());
+		new_codes.append(old_codes, 0, edit.offset).append(edit.replacement).append(old_codes, edit.offset + edit.length);
+		if (!check_size_(source, metadata.messages(), new_codes.size())) return false;
+
+		line_index new_lines(new_codes);
+		const line_index old_lines = std::move(source.lines_);
+		const std::vector<preprocessed_line> old_preprocessed_codes = std::move(source.preprocessed_codes_);
+		token_buffer old_tokens = std::move(source.tokens_);
 
-				std::size_t temp = i + 1;
-				if (isdigit(next_token.data()[0]))
+		const std::ptrdiff_t delta = static_cast<std::ptrdiff_t>(edit.replacement.size()) - static_cast<std::ptrdiff_t>(edit.length);
+		const std::ptrdiff_t line_delta = static_cast<std::ptrdiff_t>(new_lines.count()) - static_cast<std::ptrdiff_t>(old_lines.count());
+
+		// Preprocessing stops at the first empty line, so nothing after it is ever lexed.
+		const auto first_empty_line = [](const line_index& lines)
+		{
+			std::size_t line = 1;
+			while (line <= lines.count() && lines.line_begin(line) != lines.line_end(line))
+			{
+				++line;
+			}
+
+			return line;
+		};
+		const std::size_t old_end_line = first_empty_line(old_lines);
+		const std::size_t new_end_line = first_empty_line(new_lines);
+
+		// The old tokens can only be resumed one line past the edit, as an edit at the end of a line may change its EOL.
+		const std::size_t first_resumable_line = old_lines.line(edit.offset + edit.length) + 2;
+		std::size_t first_line = std::max<std::size_t>(old_lines.line(edit.offset), 2) - 1;
+		const std::size_t first_changed_index = old_tokens.index_at(first_line <= old_lines.count() ? old_lines.line_begin(first_line) : old_codes.size());
+		std::size_t first_index = 0;
+
+		// Relexing begins on a line lexed outside a multiline comment, after a token that no relexed token can merge into.
+		// A number may look up to two raw tokens ahead, so one that close to the edit is relexed too, and so is a decimal,
+		// whose data doesn't show how far it reached when it absorbed tokens on the lines that follow.
+		while (true)
+		{
+			const auto iter = std::upper_bound(old_preprocessed_codes.begin(), old_preprocessed_codes.end(), first_line,
+				[](std::size_t line, const preprocessed_line& preprocessed)
 				{
-					lex_number_(internal_lexing_data_{ source, metadata, tokens, next_token, temp }, true);
+					return line < preprocessed.line;
+				});
+			if (iter == old_preprocessed_codes.begin())
+			{
+				first_line = 1;
+				first_index = 0;
+				break;
+			}
+
+			first_line = std::prev(iter)->line;
+			first_index = old_tokens.index_at(old_lines.line_begin(first_line));
+
+			if (old_tokens.in_comment(first_line))
+			{
+				--first_line;
+				continue;
+			}
+			else if (first_index == 0) break;
+
+			const token_view prev_token = old_tokens[first_index - 1];
+
+			if (prev_token.end_offset() > old_lines.line_begin(first_line) || prev_token.type() == token_type::decimal ||
+				(is_number(prev_token.type()) && first_changed_index - first_index < 2))
+			{
+				first_line = old_lines.line(prev_token.offset());
+				continue;
+			}
+
+			break;
+		}
+
+		// The old codes die here. Tokens before the edit keep their offsets, so the old buffer can still read them.
+		source.codes(std::move(new_codes), std::move(new_lines));
+
+		const std::string_view codes = source.codes();
+		const line_index& lines = source.lines();
+		old_tokens.codes(codes);
+
+		std::vector<preprocessed_line> preprocessed_codes;
+		for (const preprocessed_line& preprocessed : old_preprocessed_codes)
+		{
+			if (preprocessed.line >= first_line) break;
+			preprocessed_codes.push_back({ lines.line_data(codes, preprocessed.line), preprocessed.line });
+		}
+
+		// Diagnostics are held back and published in the order lex_source would publish them.
+		dlink::messages preprocessing_messages;
+		dlink::messages line_messages;
+		dlink::messages token_messages;
+		bool ok = true;
+		bool tokens_ok = true;
+		line_lexing_state_ state;
+
+		std::vector<token> raw_tokens;
+		std::size_t raw_index = 0;
+		std::vector<token> tokens;
+		token prev_token;
+		const bool has_prev_token = first_index != 0;
 
-					if (next_token.type() != token_type::integer_dec)
+		if (has_prev_token)
+		{
+			prev_token = old_tokens[first_index - 1].to_token();
+		}
+
+		const auto lex_tokens = [&](std::size_t end, bool finished)
+		{
+			while (raw_index < end && (finished || raw_tokens.size() - raw_index >= 3))
+			{
+				const std::size_t cur_index = raw_index;
+
+				if (lex_token_(source, token_messages, raw_tokens, raw_index, !tokens.empty() ? &tokens.back() : has_prev_token ? &prev_token : nullptr, tokens_ok))
+				{
+					tokens.push_back(raw_tokens[cur_index]);
+				}
+
+				++raw_index;
+			}
+		};
+
+		std::size_t resumed_line = 0, resumed_index = 0;
+
+		for (std::size_t line = first_line; line < new_end_line; ++line)
+		{
+			const std::string_view current_line = lines.line_data(codes, line);
+			const std::size_t preprocessing_mark = preprocessing_messages.size();
+			const std::size_t line_mark = line_messages.size();
+
+			if (!preprocessor::preprocess_line_(source, preprocessing_messages, current_line, line, ok)) continue;
+
+			const std::size_t line_begin = raw_tokens.size();
+			const bool multiline_comment = state.multiline_comment;
+			lex_line_(source, line_messages, current_line, line, lines.line_begin(line), state, raw_tokens);
+
+			// The old tokens resume at a line the lexer reaches in the same state, with nothing before it that reaches into it.
+			const std::size_t old_line = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(line) - line_delta);
+
+			if (ok && state.ok && old_line >= first_resumable_line && old_line < old_end_line &&
+				old_lines.line_begin(old_line) + delta == lines.line_begin(line) && old_tokens.in_comment(old_line) == multiline_comment)
+			{
+				lex_tokens(line_begin, false);
+
+				const std::size_t old_index = old_tokens.index_at(old_lines.line_begin(old_line));
+				const token* const last_token = !tokens.empty() ? &tokens.back() : has_prev_token ? &prev_token : nullptr;
+
+				if (raw_index == line_begin && (!last_token || !is_number(last_token->type())) &&
+					(old_index == 0 || (!is_number(old_tokens[old_index - 1].type()) && old_tokens[old_index - 1].end_offset() <= old_lines.line_begin(old_line))))
+				{
+					preprocessing_messages.resize(preprocessing_mark);
+					line_messages.resize(line_mark);
+
+					while (!state.comment_lines.empty() && state.comment_lines.back() >= line)
 					{
-						metadata.messages().push_back(std::make_shared<error_message>(
-							2011, message_data::def.error(2011)(),
-							generate_line_col(source.path(), prev_token.line(), prev_token.col() + 1),
-							generate_source(cur_token.line_data(), prev_token.line(), prev_token.col() + 1, prev_token.data().size() + 1)
-							));
-						ok = false;
+						state.comment_lines.pop_back();
 					}
 
-					prev_token.type(token_type::decimal);
-					prev_token.data(std::string_view(prev_token.data().data(), prev_token.data().size() + next_token.data().size() + 1));
-					prev_token.postfix_literal(next_token.postfix_literal());
+					resumed_line = old_line;
+					resumed_index = old_index;
+					break;
+				}
+			}
+
+			preprocessed_codes.push_back({ current_line, line });
+			lex_tokens(raw_tokens.size(), false);
+		}
+
+		for (message_ptr& message : preprocessing_messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+
+		if (!ok) return false;
+
+		if (resumed_line != 0)
+		{
+			for (auto iter = std::lower_bound(old_preprocessed_codes.begin(), old_preprocessed_codes.end(), resumed_line,
+				[](const preprocessed_line& preprocessed, std::size_t line)
+				{
+					return preprocessed.line < line;
+				}); iter != old_preprocessed_codes.end(); ++iter)
+			{
+				const std::size_t line = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(iter->line) + line_delta);
+				preprocessed_codes.push_back({ lines.line_data(codes, line), line });
+			}
+		}
+		else
+		{
+			lex_tokens(raw_tokens.size(), true);
+			lex_end_(source, line_messages, state);
+		}
+
+		source.preprocessed_codes(std::move(preprocessed_codes));
+
+		for (message_ptr& message : line_messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+		if (!state.ok) return false;
+
+		for (message_ptr& message : token_messages)
+		{
+			metadata.messages().push_back(std::move(message));
+		}
+
+		token_buffer buffer;
+		std::size_t identifiers = 0;
+
+		buffer.codes(codes);
+		buffer.reserve(tokens.size());
+
+		for (const token& token : tokens)
+		{
+			identifiers += push_token_(source, metadata, metadata.messages(), token, buffer, tokens_ok);
+		}
+
+		metadata.interner().add_lookups(identifiers);
+		if (!tokens_ok) return false;
+
+		// The relexed tokens replace the old ones in place, and the ones after them are moved to their new offsets.
+		std::vector<std::size_t> comment_lines = old_tokens.comment_lines();
+		const std::size_t comment_lines_begin = std::lower_bound(comment_lines.begin(), comment_lines.end(), first_line) - comment_lines.begin();
+		const std::size_t comment_lines_end = resumed_line != 0 ?
+			std::lower_bound(comment_lines.begin(), comment_lines.end(), resumed_line) - comment_lines.begin() : comment_lines.size();
+
+		for (std::size_t i = comment_lines_end; i < comment_lines.size(); ++i)
+		{
+			comment_lines[i] = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(comment_lines[i]) + line_delta);
+		}
 
-					tokens.erase(tokens.begin() + (i + 1));
-					tokens.erase(tokens.begin() + i--);
+		comment_lines.erase(comment_lines.begin() + comment_lines_begin, comment_lines.begin() + comment_lines_end);
+		comment_lines.insert(comment_lines.begin() + comment_lines_begin, state.comment_lines.begin(), state.comment_lines.end());
+
+		old_tokens.splice(first_index, resumed_line != 0 ? resumed_index : old_tokens.size(), buffer, delta);
+		old_tokens.comment_lines(std::move(comment_lines));
+		source.tokens(std::move(old_tokens));
+		return true;
+	}
+
+	bool lexer::check_size_(const source& source, dlink::messages& messages, std::size_t size)
+	{
+		// Tokens are stored as 32-bit offsets into the codes, so the edit or the input is rejected before a token is stored.
+		if (size <= std::numeric_limits<std::uint32_t>::max()) return true;
+
+		messages.push_back(std::make_shared<error_message>(2013, message_data::def.error(2013)(), source.path()));
+		return false;
+	}
+	bool lexer::lex_tokens_(const source& source, compiler_metadata& metadata, std::vector<token>& tokens, token_buffer& buffer)
+	{
+		bool ok = true;
+
+		// Tokens are compacted forward: the first 'kept' tokens are final, and everything from 'i' on has not been visited yet.
+		std::size_t kept = 0;
+
+		for (std::size_t i = 0; i < tokens.size(); ++i)
+		{
+			const std::size_t cur_index = i;
+
+			if (lex_token_(source, metadata.messages(), tokens, i, kept ? &tokens[kept - 1] : nullptr, ok))
+			{
+				if (kept != cur_index)
+				{
+					tokens[kept] = tokens[cur_index];
+				}
+
+				++kept;
+			}
+		}
+
+		// Numeric literals are evaluated once they are final, as no later token can merge into them anymore.
+		std::size_t identifiers = 0;
+
+		buffer.codes(source.codes());
+		buffer.reserve(kept);
+
+		for (std::size_t i = 0; i < kept; ++i)
+		{
+			identifiers += push_token_(source, metadata, metadata.messages(), tokens[i], buffer, ok);
+		}
+
+		metadata.interner().add_lookups(identifiers);
+		return ok;
+	}
+	bool lexer::push_token_(const source& source, compiler_metadata& metadata, dlink::messages& messages, const token& token,
+							token_buffer& buffer, bool& ok)
+	{
+		number_value value;
+
+		if (token.type() == token_type::identifier)
+		{
+			buffer.push_back(token, metadata.interner().intern(token.data()));
+			return true;
+		}
+		else if (is_number(token.type()) && evaluate_number_(source, messages, token, value, ok))
+		{
+			buffer.push_back(token, value);
+		}
+		else
+		{
+			buffer.push_back(token);
+		}
+
+		return false;
+	}
+	bool lexer::lex_token_(const source& source, dlink::messages& messages, std::vector<token>& tokens, std::size_t& i,
+						   token* prev_token, bool& ok)
+	{
+		token& cur_token = tokens[i];
+		const token_type cur_token_type = cur_token.type();
+
+		if (cur_token_type == token_type::none_hm)
+		{
+#define make_internal_lexing_data() (internal_lexing_data_{ source, messages, tokens, cur_token, i })
+
+			const char first_c = cur_token.data()[0];
+
+			if (isdigit(first_c))
+			{
+				ok = lex_number_(make_internal_lexing_data()) && ok;
+			}
+			else
+			{
+				if (const token_type keyword = find_keyword(cur_token.data()); keyword != token_type::none)
+				{
+					cur_token.type(keyword);
 				}
 				else
 				{
-					prev_token.type(token_type::decimal);
-					prev_token.data(std::string_view(prev_token.data().data(), prev_token.data().size() + 1));
-					prev_token.postfix_literal(next_token.data());
+					cur_token.type(token_type::identifier);
+				}
+			}
+
+#undef make_internal_lexing_data
+		}
+		else if (cur_token_type == token_type::dot)
+		{
+			if (!prev_token || i + 1 >= tokens.size()) return true;
+
+			token& next_token = tokens[i + 1];
+
+			if (prev_token->type() != token_type::integer_dec) return true;
+			else if (next_token.type() != token_type::none_hm)
+			{
+				prev_token->type(token_type::decimal);
+				prev_token->data(std::string_view(prev_token->data().data(), prev_token->data().size() + 1));
 
-					tokens.erase(tokens.begin() + (i + 1));
-					tokens.erase(tokens.begin() + i--);
+				return false;
+			}
+
+			std::size_t temp = i + 1;
+			if (isdigit(next_token.data()[0]))
+			{
+				lex_number_(internal_lexing_data_{ source, messages, tokens, next_token, temp }, true);
+
+				if (next_token.type() != token_type::integer_dec)
+				{
+					const line_index& lines = source.lines();
+					const std::size_t prev_token_line = lines.line(prev_token->offset());
+					const std::size_t prev_token_col = lines.col(prev_token->offset()) + 1;
+
+					messages.push_back(std::make_shared<error_message>(
+						2011, message_data::def.error(2011)(),
+						generate_line_col(source.path(), prev_token_line, prev_token_col),
+						generate_source(lines.line_data(source.codes(), lines.line(cur_token.offset())), prev_token_line, prev_token_col,
+										prev_token->data().size() + 1)
+						));
+					ok = false;
 				}
+
+				prev_token->type(token_type::decimal);
+				prev_token->data(std::string_view(prev_token->data().data(), prev_token->data().size() + next_token.data().size() + 1));
+				prev_token->postfix_literal(next_token.postfix_literal());
 			}
-			else if (cur_token_type == token_type::whitespace)
+			else
 			{
-				tokens.erase(tokens.begin() + i--);
+				prev_token->type(token_type::decimal);
+				prev_token->data(std::string_view(prev_token->data().data(), prev_token->data().size() + 1));
+				prev_token->postfix_literal(next_token.data());
 			}
+
+			++i;
+			return false;
+		}
+		else if (cur_token_type == token_type::whitespace)
+		{
+			return false;
 		}
 
-		if (ok)
+		return true;
+	}
+
+	bool lexer::evaluate_number_(const source& source, dlink::messages& messages, const token& token, number_value& value, bool& ok)
+	{
+		switch (evaluate_number(token, value))
+		{
+		case number_evaluation::ok:
+			return true;
+
+		case number_evaluation::overflow:
 		{
-			source.tokens(std::move(tokens));
+			const line_index& lines = source.lines();
+			const std::size_t token_line = lines.line(token.offset());
+			const std::size_t token_col = lines.col(token.offset()) + 1;
+
+			messages.push_back(std::make_shared<error_message>(
+				2012, message_data::def.error(2012)(),
+				generate_line_col(source.path(), token_line, token_col),
+				generate_source(lines.line_data(source.codes(), token_line), token_line, token_col, token.data().size())
+				));
+			ok = false;
+			return false;
 		}
 
-		return ok;
+		default:
+			// The lexer lets a few malformed shapes through, like '1e5.5'. They are left without a value.
+			return false;
+		}
 	}
 
 	bool lexer::check_invalid_identifier(const std::string_view& string)
 	{
-		boost::iostreams::stream<boost::iostreams::basic_array_source<char>> stream(string.data(), string.size());
-		char next_c;
+		const char* current = string.data();
+		const char* const end = current + string.size();
 
-		while (true)
+		while (current < end)
 		{
-			if (is_whitespace(stream, next_c))
+			whitespace whitespace_type;
+
+			if (const std::size_t whitespace_size = match_whitespace(current, end, whitespace_type); whitespace_size)
 			{
-				if (stream.eof()) return false;
-				else return true;
+				// A single-byte whitespace at the end is treated like the end itself.
+				return whitespace_size != 1 || current + 1 != end;
 			}
-			else if (is_special_character(next_c)) return true;
 
-			stream.seekg(get_character_length(next_c) - 1, std::ios::cur);
+			const char next_c = *current;
+			if (is_special_character(next_c)) return true;
+
+			// Multi-byte characters are stepped over twice, matching the stream-based check this replaced.
+			current += 2 * get_character_length_unchecked(next_c) - 1;
 		}
 
-		return false;
+		return current != end;
 	}
 
-	bool lexer::lex_preprocess_(source& source, compiler_metadata& metadata, std::vector<token>& tokens)
+	bool lexer::lex_preprocess_(const source& source, dlink::messages& messages, std::vector<token>& tokens,
+								std::vector<std::size_t>& comment_lines)
 	{
-		using memstream = boost::iostreams::stream<boost::iostreams::basic_array_source<char>>;
+		const line_index& lines = source.lines();
+		line_lexing_state_ state;
 
-		std::size_t line = 0;
-		bool ok = true;
+		for (const preprocessed_line& preprocessed : source.preprocessed_codes())
+		{
+			lex_line_(source, messages, preprocessed.data, preprocessed.line, lines.line_begin(preprocessed.line), state, tokens);
+		}
+
+		comment_lines = std::move(state.comment_lines);
+		return lex_end_(source, messages, state);
+	}
+#ifdef DLINK_MULTITHREADING
+	bool lexer::lex_preprocess_parallel_(const source& source, compiler_metadata& metadata, std::vector<token>& tokens,
+										 std::vector<std::size_t>& comment_lines, std::size_t chunk_size)
+	{
+		const std::vector<preprocessed_line>& preprocessed_codes = source.preprocessed_codes();
+		const line_index& lines = source.lines();
+
+		std::vector<std::size_t> chunk_begins;
+		std::size_t chunk_bytes = chunk_size;
+
+		for (std::size_t i = 0; i < preprocessed_codes.size(); ++i)
+		{
+			if (chunk_bytes >= chunk_size)
+			{
+				chunk_begins.push_back(i);
+				chunk_bytes = 0;
+			}
+
+			chunk_bytes += preprocessed_codes[i].data.size();
+		}
+
+		chunk_begins.push_back(preprocessed_codes.size());
+
+		// The only state carried from one line to the next is whether a multiline comment is open, so every chunk is
+		// lexed once as if it began outside a comment and once as if it began inside one.
+		struct chunk_result
+		{
+			std::vector<token> tokens;
+			dlink::messages messages;
+			line_lexing_state_ state;
+		};
+
+		const std::size_t count_of_chunks = chunk_begins.size() - 1;
+		std::vector<chunk_result> results(count_of_chunks * 2);
+
+		auto lex_multithread = [&](std::size_t begin, std::size_t end) -> bool
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const std::size_t chunk = i / 2;
+				chunk_result& result = results[i];
+				result.state.multiline_comment = i % 2 != 0;
+
+				// The first chunk always begins outside a comment.
+				if (chunk == 0 && result.state.multiline_comment) continue;
+
+				for (std::size_t line = chunk_begins[chunk]; line < chunk_begins[chunk + 1]; ++line)
+				{
+					const preprocessed_line& preprocessed = preprocessed_codes[line];
+					lex_line_(source, result.messages, preprocessed.data, preprocessed.line, lines.line_begin(preprocessed.line), result.state, result.tokens);
+				}
+			}
 
-		bool multiline_comment = false;
-		std::size_t multiline_comment_line = 0, multiline_comment_col = 0;
-		std::string_view multiline_comment_line_data;
+			return true;
+		};
+
+		parallel(lex_multithread, get_threading_info(metadata, results.size()));
+
+		line_lexing_state_ state;
+
+		for (std::size_t chunk = 0; chunk < count_of_chunks; ++chunk)
+		{
+			chunk_result& result = results[chunk * 2 + (state.multiline_comment ? 1 : 0)];
+
+			tokens.insert(tokens.end(), result.tokens.begin(), result.tokens.end());
+			comment_lines.insert(comment_lines.end(), result.state.comment_lines.begin(), result.state.comment_lines.end());
+
+			for (message_ptr& message : result.messages)
+			{
+				metadata.messages().push_back(std::move(message));
+			}
+
+			state.ok = state.ok && result.state.ok;
+
+			// A comment that was already open when the chunk began, and never closed, keeps the beginning it had.
+			if (result.state.multiline_comment && result.state.multiline_comment_line != 0)
+			{
+				state.multiline_comment_line = result.state.multiline_comment_line;
+				state.multiline_comment_col = result.state.multiline_comment_col;
+				state.multiline_comment_line_data = result.state.multiline_comment_line_data;
+			}
+
+			state.multiline_comment = result.state.multiline_comment;
+		}
 
-		for (std::string_view current_line : source.preprocessed_codes())
+		return lex_end_(source, metadata.messages(), state);
+	}
+#endif
+	void lexer::lex_line_(const source& source, dlink::messages& messages, const std::string_view& current_line,
+						  std::size_t line, std::size_t line_offset, line_lexing_state_& state, std::vector<token>& tokens)
+	{
+		const std::size_t length = current_line.size();
+		const char* const begin = current_line.data();
+		const char* const end = begin + length;
+		const char* current = begin;
+		bool eof = false;
+
+		// A read past the end sets eof.
+		const auto read = [&current, end, &eof](char& c) noexcept
 		{
-			++line;
+			if (current == end)
+			{
+				eof = true;
+				return false;
+			}
 
-			const std::size_t length = current_line.size();
-			memstream line_stream(current_line.data(), length);
+			c = *current++;
+			return true;
+		};
 
-			char next_c;
-			int next_c_size;
-			std::size_t hm_length = 0;
+		char next_c = 0;
+		int next_c_size;
+		std::size_t hm_length = 0;
 
-			bool is_prev_whitespace = false;
-			bool string = false;
-			bool character = false;
-			std::size_t string_or_character_line = 0, string_or_character_col = 0;
+		if (state.multiline_comment)
+		{
+			state.comment_lines.push_back(line);
+		}
 
-			while (!line_stream.eof())
+		bool is_prev_whitespace = false;
+		bool string = false;
+		bool character = false;
+		std::size_t string_or_character_line = 0, string_or_character_col = 0;
+
+		while (!eof)
+		{
+			const std::size_t offset = static_cast<std::size_t>(current - begin);
+			bool isw = true;
+
+			if (current == end)
 			{
-				const std::size_t offset = static_cast<std::size_t>(line_stream.tellg());
+				eof = true;
+			}
+			else
+			{
+				whitespace whitespace_type;
+				const std::size_t whitespace_size = match_whitespace(current, end, whitespace_type);
+
+				next_c = *current;
+				current += whitespace_size ? whitespace_size : get_character_length_unchecked(next_c);
+				isw = whitespace_size != 0;
 
-				if (const bool isw = is_whitespace(line_stream, next_c); next_c_size = get_character_length(next_c), isw)
+				// A single-byte whitespace at the end is treated like the end itself.
+				if (whitespace_size == 1 && current == end)
 				{
-					if (hm_length)
+					eof = true;
+				}
+			}
+
+			if (next_c_size = get_character_length_unchecked(next_c); isw)
+			{
+				if (hm_length)
+				{
+					const std::size_t hm_offset = offset - hm_length;
+					tokens.emplace_back(current_line.substr(hm_offset, hm_length), token_type::none_hm, line_offset + hm_offset);
+					hm_length = 0;
+				}
+
+				if (!is_prev_whitespace)
+				{
+					tokens.emplace_back(std::string_view(), token_type::whitespace, static_cast<std::size_t>(-1));
+					is_prev_whitespace = true;
+				}
+
+				// The blanks that follow wouldn't add anything, so they are skipped at once, ending the line if they reach its end.
+				if (!eof)
+				{
+					if (const std::size_t blank_length = match_blank_run(current, end); blank_length)
 					{
-						const std::size_t hm_offset = offset - hm_length;
-						tokens.emplace_back(current_line.substr(hm_offset, hm_length), token_type::none_hm, line, hm_offset, current_line);
-						hm_length = 0;
+						current += blank_length;
+						eof = current == end;
 					}
+				}
+			}
+			else if (is_prev_whitespace = false, is_special_character(next_c))
+			{
+				if (hm_length && !string && !character)
+				{
+					const std::size_t hm_offset = offset - hm_length;
+					tokens.emplace_back(current_line.substr(hm_offset, hm_length), token_type::none_hm, line_offset + hm_offset);
+					hm_length = 0;
+				}
 
-					if (!is_prev_whitespace)
+				if (!state.multiline_comment && next_c == '/')
+				{
+					if (read(next_c) && next_c == '*')
+					{
+						state.multiline_comment = true;
+						state.multiline_comment_line = line;
+						state.multiline_comment_col = offset + 1;
+						state.multiline_comment_line_data = current_line;
+					}
+					else if (next_c == '/')
+					{
+						break;
+					}
+					else goto add;
+				}
+				else if (state.multiline_comment && next_c == '*')
+				{
+					if (read(next_c) && next_c == '/')
+					{
+						state.multiline_comment = false;
+					}
+					else goto add;
+				}
+				else if (!string && !character)
+				{
+					if (next_c == '"')
+					{
+						hm_length = 1;
+						string = true;
+						string_or_character_line = line;
+						string_or_character_col = offset + 1;
+					}
+					else if (next_c == '\'')
 					{
-						tokens.emplace_back(std::string_view(), token_type::whitespace, -1, -1, current_line);
-						is_prev_whitespace = true;
+						hm_length = 1;
+						character = true;
+						string_or_character_line = line;
+						string_or_character_col = offset + 1;
 					}
+					else goto add;
 				}
-				else if (is_prev_whitespace = false, is_special_character(next_c))
+				else if (string)
 				{
-					if (hm_length && !string && !character)
+					if (next_c == '"')
 					{
-						const std::size_t hm_offset = offset - hm_length;
-						tokens.emplace_back(current_line.substr(hm_offset, hm_length), token_type::none_hm, line, hm_offset, current_line);
+						tokens.emplace_back(current_line.substr(offset - hm_length, hm_length + 1), token_type::string, line_offset + offset - hm_length);
 						hm_length = 0;
+						string = false;
 					}
-
-					if (!multiline_comment && next_c == '/')
+					else if (next_c == '\\')
 					{
-						line_stream.read(&next_c, 1);
-						if (line_stream.good() && next_c == '*')
-						{
-							multiline_comment = true;
-							multiline_comment_line = line;
-							multiline_comment_col = offset + 1;
-							multiline_comment_line_data = current_line;
-						}
-						else if (next_c == '/')
-						{
-							break;
-						}
-						else goto add;
+						// The escaped character belongs to the literal, even when it is a quote.
+						hm_length += read(next_c) ? 2 : 1;
 					}
-					else if (multiline_comment && next_c == '*')
+					else goto add;
+				}
+				else if (character)
+				{
+					if (next_c == '\'')
 					{
-						line_stream.read(&next_c, 1);
-						if (line_stream.good() && next_c == '/')
-						{
-							multiline_comment = false;
-						}
-						else goto add;
+						tokens.emplace_back(current_line.substr(offset - hm_length, hm_length + 1), token_type::character, line_offset + offset - hm_length);
+						hm_length = 0;
+						character = false;
 					}
-					else if (!string && !character)
+					else if (next_c == '\\')
 					{
-						if (next_c == '"')
-						{
-							hm_length = 1;
-							string = true;
-							string_or_character_line = line;
-							string_or_character_col = offset + 1;
-						}
-						else if (next_c == '\'')
-						{
-							hm_length = 1;
-							character = true;
-							string_or_character_line = line;
-							string_or_character_col = offset + 1;
-						}
-						else goto add;
+						hm_length += read(next_c) ? 2 : 1;
 					}
-					else if (string)
+					else goto add;
+				}
+				else
+				{
+				add:
+					if ((string && next_c == '\'') || (character && next_c == '"'))
 					{
-						if (next_c == '"')
-						{
-							tokens.emplace_back(current_line.substr(offset - hm_length, hm_length + 1), token_type::string, line, offset - hm_length, current_line);
-							hm_length = 0;
-							string = false;
-						}
-						else if (next_c == '\\')
-						{
-							hm_length += 2;
-						}
-						else goto add;
+						hm_length += next_c_size;
 					}
-					else if (character)
+					else if (!is_valid_special_character(next_c))
 					{
-						if (next_c == '\'')
-						{
-							tokens.emplace_back(current_line.substr(offset - hm_length, hm_length + 1), token_type::character, line, offset - hm_length, current_line);
-							hm_length = 0;
-							character = false;
-						}
-						else if (next_c == '\\')
-						{
-							hm_length += 2;
-						}
-						else goto add;
+						using namespace std::string_literals;
+
+						messages.push_back(std::make_shared<error_message>(
+							2006, message_data::def.error(2006)(next_c),
+							generate_line_col(source.path(), line, offset + 1),
+							generate_source(current_line, line, offset + 1, 1)
+							));
+						state.ok = false;
 					}
 					else
 					{
-					add:
-						if ((string && next_c == '\'') || (character && next_c == '"'))
-						{
-							hm_length += next_c_size;
-						}
-						else if (!is_valid_special_character(next_c))
-						{
-							using namespace std::string_literals;
+						// A '/' or '*' that neither opens nor closes a comment comes here with the character after it, which is
+						// matched as if the operator began there while the data of the token still begins at the '/' or '*'.
+						token_type type = token_type::none;
+						const std::size_t length = std::max<std::size_t>(match_operator(current - 1, end, type), 1);
 
-							metadata.messages().push_back(std::make_shared<error_message>(
-								2006, message_data::def.error(2006)(next_c),
-								generate_line_col(source.path(), line, offset + 1),
-								generate_source(current_line, line, offset + 1, 1)
-								));
-							ok = false;
-						}
-						else
+						tokens.emplace_back(current_line.substr(offset, length), type, line_offset + offset);
+						current += length - 1;
+
+						// A line that ends in an operator which could have been longer isn't closed by a whitespace token, so a
+						// number can still take the sign of its exponent from the end of one line and its digits from the next.
+						if (length < max_operator_length && current == end && !is_single_special_character(next_c))
 						{
-							token& added_token = tokens.emplace_back(current_line.substr(offset, 1), to_token_type(next_c), line, offset, current_line);
-							if (!is_single_special_character(next_c))
-							{
-								static constexpr int max_depth = 3;
-								token_type old_type = added_token.type();
-
-								for (int i = 1; i < max_depth; ++i)
-								{
-									line_stream.read(&next_c, 1);
-									if (line_stream.good())
-									{
-										if (is_valid_special_character(next_c))
-										{
-											added_token.type(complex_token_type(added_token.type(), next_c));
-
-											if (const token_type new_type = added_token.type(); new_type != old_type)
-											{
-												old_type = new_type;
-												added_token.data(current_line.substr(offset, i + 1));
-											}
-											else
-											{
-												line_stream.seekg(-1, std::ios::cur);
-												break;
-											}
-										}
-										else
-										{
-											line_stream.seekg(-1, std::ios::cur);
-											break;
-										}
-									}
-									else break;
-								}
-							}
+							eof = true;
 						}
 					}
 				}
-				else if (!multiline_comment)
-				{
-					hm_length += next_c_size;
-				}
 			}
-
-			if (character)
+			else
 			{
-				using namespace std::string_literals;
+				// The rest of an identifier or a number is consumed at once.
+				const std::size_t word_length = match_word_run(current, end);
+				current += word_length;
 
-				metadata.messages().push_back(std::make_shared<error_message>(
-					2008, message_data::def.error(2008)(),
-					generate_line_col(source.path(), string_or_character_line, string_or_character_col),
-					generate_source(current_line, string_or_character_line, string_or_character_col, 1)
-					));
-				ok = false;
+				if (!state.multiline_comment)
+				{
+					hm_length += next_c_size + word_length;
+				}
 			}
-			else if (string)
-			{
-				using namespace std::string_literals;
+		}
 
-				metadata.messages().push_back(std::make_shared<error_message>(
-					2009, message_data::def.error(2009)(),
-					generate_line_col(source.path(), string_or_character_line, string_or_character_col),
-					generate_source(current_line, string_or_character_line, string_or_character_col, 1)
-					));
-				ok = false;
-			}
-			else if (hm_length)
-			{
-				const std::size_t hm_offset = length - hm_length;
-				tokens.emplace_back(current_line.substr(hm_offset, hm_length), token_type::none_hm, line, hm_offset, current_line);
-			}
+		if (character)
+		{
+			using namespace std::string_literals;
+
+			messages.push_back(std::make_shared<error_message>(
+				2008, message_data::def.error(2008)(),
+				generate_line_col(source.path(), string_or_character_line, string_or_character_col),
+				generate_source(current_line, string_or_character_line, string_or_character_col, 1)
+				));
+			state.ok = false;
 		}
+		else if (string)
+		{
+			using namespace std::string_literals;
 
-		if (multiline_comment)
+			messages.push_back(std::make_shared<error_message>(
+				2009, message_data::def.error(2009)(),
+				generate_line_col(source.path(), string_or_character_line, string_or_character_col),
+				generate_source(current_line, string_or_character_line, string_or_character_col, 1)
+				));
+			state.ok = false;
+		}
+		else if (hm_length)
+		{
+			const std::size_t hm_offset = length - hm_length;
+			tokens.emplace_back(current_line.substr(hm_offset, hm_length), token_type::none_hm, line_offset + hm_offset);
+		}
+	}
+	bool lexer::lex_end_(const source& source, dlink::messages& messages, line_lexing_state_& state)
+	{
+		if (state.multiline_comment)
 		{
 			using namespace std::string_literals;
 
-			metadata.messages().push_back(std::make_shared<error_message>(
+			messages.push_back(std::make_shared<error_message>(
 				2007, message_data::def.error(2007)(),
-				generate_line_col(source.path(), multiline_comment_line, multiline_comment_col),
-				generate_source(multiline_comment_line_data, multiline_comment_line, multiline_comment_col, 2)
+				generate_line_col(source.path(), state.multiline_comment_line, state.multiline_comment_col),
+				generate_source(state.multiline_comment_line_data, state.multiline_comment_line, state.multiline_comment_col, 2)
 				));
-			ok = false;
+			state.ok = false;
 		}
-		return ok;
+		return state.ok;
 	}
 	bool lexer::lex_number_(internal_lexing_data_ data, bool cannot_sn)
 	{
 		using namespace std::string_literals;
 
+		const line_index& lines = data.source.lines();
 		const std::string_view token_data = data.token.data();
-		const std::size_t token_line = data.token.line();
-		const std::size_t token_col = data.token.col() + 1;
+		const std::size_t token_line = lines.line(data.token.offset());
+		const std::size_t token_col = lines.col(data.token.offset()) + 1;
+		const std::string_view token_line_data = lines.line_data(data.source.codes(), token_line);
 
 		if (token_data[0] == '0')
 		{
@@ -541,10 +1224,10 @@ namespace dlink
 				{
 					if (std::isdigit(c))
 					{
-						data.metadata.messages().push_back(std::make_shared<error_message>(
+						data.messages.push_back(std::make_shared<error_message>(
 							2001, message_data::def.error(2001)(c),
-							generate_line_col(data.source.path(), token_line, data.token.col() + i + 1),
-							generate_source(data.token.line_data(), token_line, data.token.col() + i + 1, 1)
+							generate_line_col(data.source.path(), token_line, token_col + i),
+							generate_source(token_line_data, token_line, token_col + i, 1)
 							));
 						return false;
 					}
@@ -608,17 +1291,17 @@ namespace dlink
 						std::size_t temp = cur_token_index + 2;
 
 						if (next_next_token_type != token_type::none_hm) goto invalid;
-						lex_number_(internal_lexing_data_{ data.source, data.metadata, data.tokens, next_next_token, temp }, true);
+						lex_number_(internal_lexing_data_{ data.source, data.messages, data.tokens, next_next_token, temp }, true);
 
 						if (next_next_token.type() != token_type::integer_dec)
 						{
 							next_next_token.type(token_type::none_hm);
 						
 						invalid:
-							data.metadata.messages().push_back(std::make_shared<error_message>(
+							data.messages.push_back(std::make_shared<error_message>(
 								2010, message_data::def.error(2010)(),
-								generate_line_col(data.source.path(), token_line, data.token.col() + 1),
-								generate_source(data.token.line_data(), token_line, data.token.col() + 1, data.token.data().size() + next_next_token.data().size() + 1)
+								generate_line_col(data.source.path(), token_line, token_col),
+								generate_source(token_line_data, token_line, token_col, data.token.data().size() + next_next_token.data().size() + 1)
 								));
 							return false;
 						}
@@ -626,10 +1309,8 @@ namespace dlink
 						data.token.data(std::string_view(data.token.data().data(), data.token.data().size() + next_next_token.data().size() + 1));
 						data.token.postfix_literal(next_next_token.postfix_literal());
 
-						data.tokens.erase(data.tokens.begin() + (cur_token_index + 1));
-						data.tokens.erase(data.tokens.begin() + (cur_token_index + 1));
-
-						data.token_index -= 2;
+						// The sign and the exponent are now part of this token, so the caller steps over them.
+						data.token_index += 2;
 					}
 					else goto not_sn;
 				}
@@ -697,15 +1378,17 @@ namespace dlink
 			}
 		};
 
-		const std::size_t token_line = data.token.line();
-		const std::size_t token_col = data.token.col() + 1;
+		const line_index& lines = data.source.lines();
+		const std::size_t token_line = lines.line(data.token.offset());
+		const std::size_t token_col = lines.col(data.token.offset()) + 1;
+		const std::string_view token_line_data = lines.line_data(data.source.codes(), token_line);
 
 		if (data.token.data().size() == 2)
 		{
-			data.metadata.messages().push_back(std::make_shared<error_message>(
+			data.messages.push_back(std::make_shared<error_message>(
 				error_id_invalid_format(), message_data::def.error(error_id_invalid_format())(),
 				generate_line_col(data.source.path(), token_line, token_col),
-				generate_source(data.token.line_data(), token_line, token_col, 2)
+				generate_source(token_line_data, token_line, token_col, 2)
 				));
 			return false;
 		}
@@ -725,10 +1408,10 @@ namespace dlink
 			{
 				if (base == 2 && std::isdigit(c))
 				{
-					data.metadata.messages().push_back(std::make_shared<error_message>(
+					data.messages.push_back(std::make_shared<error_message>(
 						error_id_invalid_digit(), message_data::def.error(error_id_invalid_digit())(c),
-						generate_line_col(data.source.path(), token_line, data.token.col() + i + 3),
-						generate_source(data.token.line_data(), token_line, data.token.col() + i + 3, 1)
+						generate_line_col(data.source.path(), token_line, token_col + i + 2),
+						generate_source(token_line_data, token_line, token_col + i + 2, 1)
 						));
 					ok = false;
 				}
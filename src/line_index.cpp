@@ -0,0 +1,247 @@
+#include <Dlink/line_index.hpp>
+
+#include <Dlink/encoding.hpp>
+#include <Dlink/system.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+#ifdef DLINK_X86
+#	include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
+namespace dlink
+{
+	namespace
+	{
+		namespace line_scanning
+		{
+			struct state final
+			{
+				const char* data;
+				std::size_t end;
+				std::size_t limit;		// Candidates from here on are left for a later scan
+				std::size_t line_begin;
+				std::vector<std::size_t>& begins;
+				std::vector<std::size_t>& ends;
+			};
+
+			inline int count_trailing_zeros(std::uint32_t mask) noexcept
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, mask);
+
+				return static_cast<int>(index);
+#else
+				return __builtin_ctz(mask);
+#endif
+			}
+
+			// Every EOL starts with a byte that can't be a part of another character, so the kernels only look for
+			// those bytes and leave the rest to match_eol. Returns the index scanning continues from.
+			inline std::size_t scan_candidate(state& state, std::size_t index)
+			{
+				if (index >= state.limit) return state.end;
+
+				const std::size_t eol_size = match_eol(state.data + index, state.data + state.end);
+				if (!eol_size) return index + 1;
+
+				state.begins.push_back(state.line_begin);
+				state.ends.push_back(index);
+
+				return state.line_begin = index + eol_size;
+			}
+
+			void scan_scalar(state& state, std::size_t index)
+			{
+				while (index < state.end)
+				{
+					if (classify(state.data[index]) & (character_class::eol | character_class::unicode))
+					{
+						index = scan_candidate(state, index);
+					}
+					else
+					{
+						++index;
+					}
+				}
+			}
+
+#ifdef DLINK_X86
+			DLINK_TARGET("sse4.2") inline std::uint32_t candidates_sse42(__m128i input) noexcept
+			{
+#ifdef DLINK_LEAN_AND_MEAN
+				const __m128i result = _mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8('\x0A')),
+													_mm_cmpeq_epi8(input, _mm_set1_epi8('\x0D')));
+#else
+				// LF, VT, FF and CR are adjacent, so a single unsigned range check finds all of them.
+				const __m128i control = _mm_sub_epi8(input, _mm_set1_epi8('\x0A'));
+
+				__m128i result = _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8(3)), control);
+				result = _mm_or_si128(result, _mm_cmpeq_epi8(input, _mm_set1_epi8('\x1E')));
+				result = _mm_or_si128(result, _mm_cmpeq_epi8(input, _mm_set1_epi8(static_cast<char>(0xC2))));
+				result = _mm_or_si128(result, _mm_cmpeq_epi8(input, _mm_set1_epi8(static_cast<char>(0xE2))));
+#endif
+
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(result));
+			}
+			DLINK_TARGET("sse4.2") void scan_sse42(state& state, std::size_t index)
+			{
+				while (index + 16 <= state.end)
+				{
+					const std::size_t block = index;
+
+					for (std::uint32_t mask = candidates_sse42(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state.data + block)));
+						 mask; mask &= mask - 1)
+					{
+						if (const std::size_t candidate = block + count_trailing_zeros(mask); candidate >= index)
+						{
+							index = scan_candidate(state, candidate);
+						}
+					}
+
+					index = std::max(index, block + 16);
+				}
+
+				scan_scalar(state, index);
+			}
+
+			DLINK_TARGET("avx2") inline std::uint32_t candidates_avx2(__m256i input) noexcept
+			{
+#ifdef DLINK_LEAN_AND_MEAN
+				const __m256i result = _mm256_or_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8('\x0A')),
+													   _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\x0D')));
+#else
+				const __m256i control = _mm256_sub_epi8(input, _mm256_set1_epi8('\x0A'));
+
+				__m256i result = _mm256_cmpeq_epi8(_mm256_min_epu8(control, _mm256_set1_epi8(3)), control);
+				result = _mm256_or_si256(result, _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\x1E')));
+				result = _mm256_or_si256(result, _mm256_cmpeq_epi8(input, _mm256_set1_epi8(static_cast<char>(0xC2))));
+				result = _mm256_or_si256(result, _mm256_cmpeq_epi8(input, _mm256_set1_epi8(static_cast<char>(0xE2))));
+#endif
+
+				return static_cast<std::uint32_t>(_mm256_movemask_epi8(result));
+			}
+			DLINK_TARGET("avx2") void scan_avx2(state& state, std::size_t index)
+			{
+				while (index + 32 <= state.end)
+				{
+					const std::size_t block = index;
+
+					for (std::uint32_t mask = candidates_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(state.data + block)));
+						 mask; mask &= mask - 1)
+					{
+						if (const std::size_t candidate = block + count_trailing_zeros(mask); candidate >= index)
+						{
+							index = scan_candidate(state, candidate);
+						}
+					}
+
+					index = std::max(index, block + 32);
+				}
+
+				scan_scalar(state, index);
+			}
+#endif
+
+			using scanner = void(*)(state&, std::size_t);
+
+			scanner get_scanner() noexcept
+			{
+				static const scanner function = []() -> scanner
+				{
+#ifdef DLINK_X86
+					switch (get_instruction_set())
+					{
+					case instruction_set::avx512:
+					case instruction_set::avx2:
+						return scan_avx2;
+
+					case instruction_set::sse42:
+						return scan_sse42;
+
+					default:
+						break;
+					}
+#endif
+
+					return scan_scalar;
+				}();
+
+				return function;
+			}
+		}
+	}
+
+	line_index::line_index(const std::string_view& codes)
+	{
+		append(codes, 0, codes.size());
+	}
+
+	void line_index::append(const std::string_view& codes, std::size_t begin, std::size_t end)
+	{
+		line_scanning::state state{ codes.data(), end, end, begin, begins_, ends_ };
+		line_scanning::get_scanner()(state, begin);
+
+		if (state.line_begin < end)
+		{
+			begins_.push_back(state.line_begin);
+			ends_.push_back(end);
+		}
+	}
+	std::size_t line_index::append_partial(const std::string_view& codes, std::size_t begin, std::size_t& scanned, std::size_t end)
+	{
+		// An EOL is at most 3 bytes long, and a single-byte one takes the LF after it, so an EOL is only known to be complete
+		// once 2 more bytes follow the byte it begins with.
+		const std::size_t limit = end >= 2 ? end - 2 : 0;
+		line_scanning::state state{ codes.data(), end, limit, begin, begins_, ends_ };
+
+		if (const std::size_t from = std::max(scanned, begin); from < limit)
+		{
+			line_scanning::get_scanner()(state, from);
+		}
+
+		scanned = std::max({ scanned, limit, state.line_begin });
+		return state.line_begin;
+	}
+	void line_index::clear() noexcept
+	{
+		begins_.clear();
+		ends_.clear();
+	}
+	bool line_index::empty() const noexcept
+	{
+		return begins_.empty();
+	}
+	std::size_t line_index::count() const noexcept
+	{
+		return begins_.size();
+	}
+
+	std::size_t line_index::line(std::size_t offset) const noexcept
+	{
+		return static_cast<std::size_t>(std::upper_bound(begins_.begin(), begins_.end(), offset) - begins_.begin());
+	}
+	std::size_t line_index::col(std::size_t offset) const noexcept
+	{
+		const std::size_t line = this->line(offset);
+		return line ? offset - begins_[line - 1] : offset;
+	}
+	std::size_t line_index::line_begin(std::size_t line) const noexcept
+	{
+		return begins_[line - 1];
+	}
+	std::size_t line_index::line_end(std::size_t line) const noexcept
+	{
+		return ends_[line - 1];
+	}
+	std::string_view line_index::line_data(const std::string_view& codes, std::size_t line) const noexcept
+	{
+		if (line == 0 || line > begins_.size()) return std::string_view();
+		else return codes.substr(begins_[line - 1], ends_[line - 1] - begins_[line - 1]);
+	}
+}
\ No newline at end of file
@@ -148,11 +148,7 @@ namespace dlink
 {
 	bool messages::has_error() const
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(mutex());
-#endif
-
-		for (const message_ptr& message : data_stl())
+		for (const message_ptr& message : *this)
 		{
 			if (message->type() == message_type::error)
 			{
@@ -164,11 +160,7 @@ namespace dlink
 	}
 	bool messages::has_warning() const
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(mutex());
-#endif
-
-		for (const message_ptr& message : data_stl())
+		for (const message_ptr& message : *this)
 		{
 			if (message->type() == message_type::warning)
 			{
@@ -180,11 +172,7 @@ namespace dlink
 	}
 	bool messages::has_info() const
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(mutex());
-#endif
-
-		for (const message_ptr& message : data_stl())
+		for (const message_ptr& message : *this)
 		{
 			if (message->type() == message_type::info)
 			{
@@ -402,6 +390,8 @@ namespace dlink
 		error_messages_[2009] = "Unexpected EOL found in string literal.";
 		error_messages_[2010] = "Invalid scientific notation format.";
 		error_messages_[2011] = "Invalid decimal literal format.";
+		error_messages_[2012] = "Integer literal is too large to be represented in 128 bits.";
+		error_messages_[2013] = "The input is too large to be lexed; it must be smaller than 4 GiB.";
 
 		warning_messages_[1100] = "Occurred due to #warning.";
 		warning_messages_[1101] = "#warning: %1%";
@@ -1,8 +1,8 @@
 #include <Dlink/preprocessor.hpp>
 
+#include <Dlink/decoder.hpp>
 #include <Dlink/encoding.hpp>
 #include <Dlink/exception.hpp>
-#include <Dlink/utility.hpp>
 
 #include <cstddef>
 #include <string>
@@ -10,8 +10,6 @@
 #include <utility>
 #include <vector>
 
-#include <boost/iostreams/stream.hpp>
-#include <boost/iostreams/device/array.hpp>
 
 #ifdef DLINK_MULTITHREADING
 #	include <Dlink/threading.hpp>
@@ -34,7 +32,7 @@ namespace dlink
 			return result;
 		};
 
-		return parallel(preprocess_multithread, get_threading_info(metadata));
+		return parallel(preprocess_multithread, get_threading_info(metadata, sources), metadata, "preprocess");
 #else
 		return preprocess_singlethread(metadata, sources);
 #endif
@@ -55,143 +53,195 @@ namespace dlink
 		if (source.state() < source_state::decoded)
 			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::decoded' or higher when 'static bool dlink::preprocessor::preprocess_source(dlink::source&, dlink::compiler_metadata&)' method is called.");
 		
-		using memstream = boost::iostreams::stream<boost::iostreams::basic_array_source<char>>;
+		std::vector<preprocessed_line> result;
+		bool ok = true;
+
+		preprocess_lines_(source, metadata.messages(), source.codes(), source.lines(), 0, ok, result);
+
+		if (ok)
+		{
+			source.preprocessed_codes(std::move(result));
+		}
+
+		return ok;
+	}
+	bool preprocessor::preprocess_source_streaming(source& source, compiler_metadata& metadata, std::size_t chunk_size)
+	{
+		if (source.state() < source_state::initialized)
+			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::initialized' or higher when 'static bool dlink::preprocessor::preprocess_source_streaming(dlink::source&, dlink::compiler_metadata&, std::size_t)' method is called.");
 
-		std::vector<std::string> result;
+		decoding_stream stream(source, metadata, chunk_size);
+		if (!stream.is_open())
+			return decoder::decode_source(source, metadata) && preprocess_source(source, metadata);
 
-		memstream stream(const_cast<char*>(source.codes().c_str()), source.codes().length());
-		std::size_t line = 0;
-		std::string_view current_line;
+		dlink::messages messages;
+		std::vector<preprocessed_line> result;
 		bool ok = true;
+		bool stopped = false;
 
-#define continue_with_append										\
-		{															\
-			if (ok)													\
-			{														\
-				result.emplace_back(current_line);					\
-				continue;											\
-			}														\
+		while (!stream.eof())
+		{
+			const std::size_t first_line = source.lines().count();
+			if (!stream.read())
+				return false;
+
+			// The rest of the input is still decoded after the first empty line, as preprocess_source would decode it.
+			if (!stopped)
+			{
+				stopped = !preprocess_lines_(source, messages, source.codes(), source.lines(), first_line, ok, result);
+			}
+		}
+
+		// Diagnostics are published only after the whole input decoded, as preprocess_source would see it.
+		for (message_ptr& message : messages)
+		{
+			metadata.messages().push_back(std::move(message));
 		}
 
-		while (getline(stream, source.codes().c_str(), current_line))
+		if (ok)
+		{
+			source.preprocessed_codes(std::move(result));
+		}
+
+		return ok;
+	}
+
+	bool preprocessor::preprocess_lines_(const source& source, dlink::messages& messages, const std::string_view& codes,
+										 const line_index& lines, std::size_t first_line, bool& ok, std::vector<preprocessed_line>& result)
+	{
+		for (std::size_t line = first_line + 1; line <= lines.count(); ++line)
+		{
+			const std::string_view current_line = lines.line_data(codes, line);
+			if (current_line.empty())
+				return false;
+
+			if (preprocess_line_(source, messages, current_line, line, ok))
+			{
+				result.push_back({ current_line, line });
+			}
+		}
+
+		return true;
+	}
+	bool preprocessor::preprocess_line_(const source& source, dlink::messages& messages, const std::string_view& current_line,
+										std::size_t line, bool& ok)
+	{
+		const std::size_t length = current_line.size();
+		const char* current = current_line.data();
+		const char* const end = current + length;
+
+		whitespace whitespace_type;
+
+		while (current != end)
 		{
-			++line;
+			const std::size_t whitespace_size = match_whitespace(current, end, whitespace_type);
+			if (!whitespace_size) break;
 
-			const std::size_t length = current_line.size();
-			memstream line_stream(current_line.data(), length);
+			current += whitespace_size;
+		}
 
-			char next_c;
+		if ((current == end || *current != '#') && ok)
+			return true;
 
-			while (is_whitespace(line_stream, next_c));
-			if (line_stream.eof()) continue_with_append;
-			if (next_c != '#') continue_with_append;
 
 
+		const std::size_t offset = current == end ? length :
+			static_cast<std::size_t>(current - current_line.data()) + get_character_length_unchecked(*current);
+		if (offset >= length)
+		{
+			messages.push_back(std::make_shared<error_message>(
+				1100, message_data::def.error(1100)(),
+				generate_line_col(source.path(), line, offset),
+				generate_source(current_line, line, offset, 1)
+				));
+			ok = false;
+			return false;
+		}
 
-			const std::size_t offset = static_cast<std::size_t>(line_stream.tellg());
-			if (offset >= length)
+		const std::string_view other = current_line.substr(offset);
+		const std::size_t first_space_pos = other.find(' ');
+		const std::string_view type = other.substr(0, first_space_pos);
+		
+		bool loop_error = false;
+		std::size_t index = 0;
+
+		for (char c : type)
+		{
+			if (!isalpha(c))
 			{
-				metadata.messages().push_back(std::make_shared<error_message>(
-					1100, message_data::def.error(1100)(),
-					generate_line_col(source.path(), line, offset),
-					generate_source(current_line, line, offset, 1)
+				messages.push_back(std::make_shared<error_message>(
+					1101, message_data::def.error(1101)(),
+					generate_line_col(source.path(), line, offset + index + 1),
+					generate_source(current_line, line, offset + index + 1, 1)
 					));
 				ok = false;
-				continue;
+				loop_error = true;
 			}
 
-			const std::string_view other = current_line.substr(offset);
-			const std::size_t first_space_pos = other.find(' ');
-			const std::string_view type = other.substr(0, first_space_pos);
-			
-			bool loop_error = false;
-			std::size_t index = 0;
+			++index;
+		}
+
+		if (loop_error) return false;
+		loop_error = false;
 
-			for (char c : type)
+		if (type == "error")
+		{
+			if (first_space_pos == std::string_view::npos ||
+				first_space_pos == other.size() - 1)
 			{
-				if (!isalpha(c))
-				{
-					metadata.messages().push_back(std::make_shared<error_message>(
-						1101, message_data::def.error(1101)(),
-						generate_line_col(source.path(), line, offset + index + 1),
-						generate_source(current_line, line, offset + index + 1, 1)
-						));
-					ok = false;
-					loop_error = true;
-				}
-
-				++index;
+				messages.push_back(std::make_shared<error_message>(
+					1103, message_data::def.error(1103)(),
+					generate_line_col(source.path(), line, offset),
+					generate_source(current_line, line, offset, 6)
+					));
 			}
-
-			if (loop_error) continue;
-			loop_error = false;
-
-			if (type == "error")
+			else
 			{
-				if (first_space_pos == std::string_view::npos ||
-					first_space_pos == other.size() - 1)
-				{
-					metadata.messages().push_back(std::make_shared<error_message>(
-						1103, message_data::def.error(1103)(),
-						generate_line_col(source.path(), line, offset),
-						generate_source(current_line, line, offset, 6)
-						));
-				}
-				else
-				{
-					const std::string_view message = other.substr(first_space_pos + 1);
-
-					metadata.messages().push_back(std::make_shared<error_message>(
-						1104, message_data::def.error(1104)(message),
-						generate_line_col(source.path(), line, offset),
-						generate_source(current_line, line, offset, message.size() + 7)
-						));
-				}
+				const std::string_view message = other.substr(first_space_pos + 1);
 
-				ok = false;
+				messages.push_back(std::make_shared<error_message>(
+					1104, message_data::def.error(1104)(message),
+					generate_line_col(source.path(), line, offset),
+					generate_source(current_line, line, offset, message.size() + 7)
+					));
 			}
-			else if (type == "warning")
+
+			ok = false;
+		}
+		else if (type == "warning")
+		{
+			if (first_space_pos == std::string_view::npos ||
+				first_space_pos == other.size() - 1)
 			{
-				if (first_space_pos == std::string_view::npos ||
-					first_space_pos == other.size() - 1)
-				{
-					metadata.messages().push_back(std::make_shared<warning_message>(
-						1100, message_data::def.warning(1100)(),
-						generate_line_col(source.path(), line, offset),
-						generate_source(current_line, line, offset, 8)
-						));
-				}
-				else
-				{
-					const std::string_view message = other.substr(first_space_pos + 1);
-
-					metadata.messages().push_back(std::make_shared<warning_message>(
-						1101, message_data::def.warning(1101)(message),
-						generate_line_col(source.path(), line, offset),
-						generate_source(current_line, line, offset, message.size() + 9)
-						));
-				}
+				messages.push_back(std::make_shared<warning_message>(
+					1100, message_data::def.warning(1100)(),
+					generate_line_col(source.path(), line, offset),
+					generate_source(current_line, line, offset, 8)
+					));
 			}
 			else
 			{
-				metadata.messages().push_back(std::make_shared<error_message>(
-					1105, message_data::def.error(1105)(),
+				const std::string_view message = other.substr(first_space_pos + 1);
+
+				messages.push_back(std::make_shared<warning_message>(
+					1101, message_data::def.warning(1101)(message),
 					generate_line_col(source.path(), line, offset),
-					generate_source(current_line, line, offset, type.size() + 1)
+					generate_source(current_line, line, offset, message.size() + 9)
 					));
-
-				ok = false;
 			}
 		}
-
-#undef continue_with_append
-
-		if (ok)
+		else
 		{
-			source.preprocessed_codes(std::move(result));
+			messages.push_back(std::make_shared<error_message>(
+				1105, message_data::def.error(1105)(),
+				generate_line_col(source.path(), line, offset),
+				generate_source(current_line, line, offset, type.size() + 1)
+				));
+
+			ok = false;
 		}
 
-		return ok;
+		return false;
 	}
 }
 
@@ -7,10 +7,6 @@
 
 #include <utility>
 
-#ifdef DLINK_MULTITHREADING
-#	include <mutex>
-#endif
-
 namespace dlink
 {
 	source::source(const std::string_view& path)
@@ -18,23 +14,49 @@ namespace dlink
 	{
 		if (path.empty())
 		{
-			state_ = source_state::empty;
+			state_.store(source_state::empty, std::memory_order_relaxed);
 			throw std::invalid_argument("The argument 'path' can't be empty.");
 		}
 	}
+	source::source(const std::string_view& path, std::string&& codes)
+		: source(path)
+	{
+		input_.buffer = std::move(codes);
+		input_.loaded = true;
+	}
+	source::source(const std::string_view& path, const std::string_view& codes)
+		: source(path)
+	{
+		input_.borrowed = codes;
+		input_.loaded = true;
+	}
 	source::source(source&& source) noexcept
-		: codes_(std::move(source.codes_)), path_(std::move(source.path_)), state_(source.state_)
+		: state_(source_state::empty)
 	{
-		source.state_ = source_state::empty;
+		*this = std::move(source);
 	}
 
 	source& source::operator=(source&& source) noexcept
 	{
+		if (this == &source)
+			return *this;
+
+		// Taken before the move, as codes short enough to be kept inside the string are copied to this source.
+		const std::string_view old_codes = source.codes();
+
 		codes_ = std::move(source.codes_);
+		codes_mapping_ = std::move(source.codes_mapping_);
+		codes_borrowed_ = source.codes_borrowed_;
+		codes_offset_ = source.codes_offset_;
+		input_ = std::move(source.input_);
+		lines_ = std::move(source.lines_);
+		preprocessed_codes_ = std::move(source.preprocessed_codes_);
 		path_ = std::move(source.path_);
-		state_ = std::move(source.state_);
+		tokens_ = std::move(source.tokens_);
+		state_.store(source.state_.load(std::memory_order_acquire), std::memory_order_relaxed);
 
-		source.state_ = source_state::empty;
+		rebase_(old_codes);
+		source.state_.store(source_state::empty, std::memory_order_relaxed);
 
 		return *this;
 	}
@@ -65,9 +87,28 @@ namespace dlink
 
 		return lexer::lex_source(*this, metadata);
 	}
+	bool source::lex_fused(compiler_metadata& metadata)
+	{
+		if (state() < source_state::decoded)
+			throw invalid_state("The state must be 'dlink::source_state::decoded' or higher when 'bool dlink::source::lex_fused(dlink::compiler_metadata&)' method is called.");
+
+		return lexer::lex_source_fused(*this, metadata);
+	}
+	bool source::relex(compiler_metadata& metadata, const source_edit& edit)
+	{
+		if (state() < source_state::lexed)
+			throw invalid_state("The state must be 'dlink::source_state::lexed' when 'bool dlink::source::relex(dlink::compiler_metadata&, const dlink::source_edit&)' method is called.");
+
+		return lexer::relex_source(*this, metadata, edit);
+	}
 
 	bool source::compile_until_preprocessing(compiler_metadata& metadata)
 	{
+		if (const std::size_t chunk_size = metadata.options().stream_chunk_size(); chunk_size != 0 && !input_.loaded)
+		{
+			return preprocessor::preprocess_source_streaming(*this, metadata, chunk_size);
+		}
+
 		bool result = decode(metadata);
 
 		if (result)
@@ -79,6 +120,11 @@ namespace dlink
 	}
 	bool source::compile_until_lexing(compiler_metadata& metadata)
 	{
+		if (const std::size_t chunk_size = metadata.options().stream_chunk_size(); chunk_size != 0 && !input_.loaded)
+		{
+			return lexer::lex_source_streaming(*this, metadata, chunk_size);
+		}
+
 		bool result = compile_until_preprocessing(metadata);
 
 		if (result)
@@ -88,17 +134,39 @@ namespace dlink
 
 		return result;
 	}
+	bool source::compile_until_lexing_fused(compiler_metadata& metadata)
+	{
+		// Streaming already preprocesses and lexes each chunk as it is decoded.
+		if (metadata.options().stream_chunk_size() != 0 && !input_.loaded)
+			return compile_until_lexing(metadata);
+
+		bool result = decode(metadata);
+
+		if (result)
+		{
+			result = lex_fused(metadata);
+		}
+
+		return result;
+	}
 
 	nlohmann::json source::dump() const
 	{
 		nlohmann::json object;
 		object["path"] = path_;
 
-		if (state_ >= source_state::preprocessed)
+		if (state() >= source_state::preprocessed)
 		{
-			object["preprocessed"] = preprocessed_codes_;
+			nlohmann::json array = nlohmann::json::array();
+
+			for (const preprocessed_line& line : preprocessed_codes_)
+			{
+				array.push_back(line.data);
+			}
+
+			object["preprocessed"] = std::move(array);
 		}
-		if (state_ >= source_state::lexed)
+		if (state() >= source_state::lexed)
 		{
 			object["tokens"] = dump_tokens();
 		}
@@ -107,14 +175,14 @@ namespace dlink
 	}
 	nlohmann::json source::dump_tokens() const
 	{
-		if (state_ < source_state::lexed)
+		if (state() < source_state::lexed)
 			throw invalid_state("The state must be 'dlink::source_state::lexed' or higher when 'nlohmann::json dlink::source::dump_tokens(void) const' method is called.");
 
 		nlohmann::json array;
 		
-		for (const token& token : tokens_)
+		for (const token_view token : tokens_)
 		{
-			array.push_back(token.dump());
+			array.push_back(token.dump(lines_));
 		}
 
 		return array;
@@ -124,61 +192,105 @@ namespace dlink
 	{
 		return path_;
 	}
-	const std::string& source::codes() const noexcept
+	std::string_view source::codes() const noexcept
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(codes_mutex_);
-#endif
-
-		return codes_;
+		if (codes_mapping_.is_open())
+		{
+			return std::string_view(codes_mapping_.data() + codes_offset_, codes_mapping_.size() - codes_offset_);
+		}
+		else if (codes_borrowed_.data())
+		{
+			return codes_borrowed_.substr(codes_offset_);
+		}
+		else
+		{
+			return std::string_view(codes_).substr(codes_offset_);
+		}
 	}
-	const std::vector<std::string>& source::preprocessed_codes() const noexcept
+	const dlink::line_index& source::lines() const noexcept
+	{
+		return lines_;
+	}
+	const std::vector<preprocessed_line>& source::preprocessed_codes() const noexcept
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(preprocessed_codes_mutex_);
-#endif
-
 		return preprocessed_codes_;
 	}
-	const dlink::tokens& source::tokens() const noexcept
+	const dlink::token_buffer& source::tokens() const noexcept
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(tokens_mutex_);
-#endif
-
 		return tokens_;
 	}
 
 	source_state source::state() const noexcept
 	{
-		return state_;
+		return state_.load(std::memory_order_acquire);
 	}
 
-	void source::codes(std::string&& new_codes)
+	void source::codes(std::string&& new_codes, std::size_t offset)
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(codes_mutex_);
-#endif
-
 		codes_ = std::move(new_codes);
-		state_ = source_state::decoded;
+		codes_mapping_.close();
+		codes_borrowed_ = {};
+		codes_offset_ = offset;
+		lines_ = dlink::line_index(std::string_view(codes_).substr(offset));
+		publish_(source_state::decoded);
 	}
-	void source::preprocessed_codes(std::vector<std::string>&& new_preprocessed_codes)
+	void source::codes(mapped_file&& new_codes, std::size_t offset)
+	{
+		codes_.clear();
+		codes_mapping_ = std::move(new_codes);
+		codes_borrowed_ = {};
+		codes_offset_ = offset;
+		lines_ = dlink::line_index(std::string_view(codes_mapping_.data() + offset, codes_mapping_.size() - offset));
+		publish_(source_state::decoded);
+	}
+	void source::codes(const std::string_view& new_codes, std::size_t offset)
+	{
+		codes_.clear();
+		codes_mapping_.close();
+		codes_borrowed_ = new_codes;
+		codes_offset_ = offset;
+		lines_ = dlink::line_index(new_codes.substr(offset));
+		publish_(source_state::decoded);
+	}
+	void source::codes(std::string&& new_codes, dlink::line_index&& new_lines)
+	{
+		codes_ = std::move(new_codes);
+		codes_mapping_.close();
+		codes_borrowed_ = {};
+		codes_offset_ = 0;
+		lines_ = std::move(new_lines);
+		publish_(source_state::decoded);
+	}
+	void source::preprocessed_codes(std::vector<preprocessed_line>&& new_preprocessed_codes)
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(preprocessed_codes_mutex_);
-#endif
-
 		preprocessed_codes_ = std::move(new_preprocessed_codes);
-		state_ = source_state::preprocessed;
+		publish_(source_state::preprocessed);
 	}
-	void source::tokens(dlink::tokens&& new_tokens)
+	void source::tokens(dlink::token_buffer&& new_tokens)
 	{
-#ifdef DLINK_MULTITHREADING
-		std::lock_guard<std::mutex> guard(tokens_mutex_);
-#endif
-
 		tokens_ = std::move(new_tokens);
-		state_ = source_state::lexed;
+		publish_(source_state::lexed);
+	}
+	void source::publish_(source_state new_state) noexcept
+	{
+		state_.store(new_state, std::memory_order_release);
+	}
+	void source::rebase_(const std::string_view& old_codes) noexcept
+	{
+		const std::string_view new_codes = codes();
+
+		// Mapped, borrowed and long codes stay where they are.
+		if (old_codes.data() == new_codes.data())
+			return;
+
+		for (preprocessed_line& line : preprocessed_codes_)
+		{
+			if (line.data.data() >= old_codes.data() && line.data.data() <= old_codes.data() + old_codes.size())
+			{
+				line.data = std::string_view(new_codes.data() + (line.data.data() - old_codes.data()), line.data.size());
+			}
+		}
+
+		tokens_.codes(new_codes);
 	}
 }
\ No newline at end of file
@@ -1,12 +1,29 @@
 #include <Dlink/system.hpp>
 
+#include <algorithm>
 #include <cstdint>
 #include <stdexcept>
+#include <utility>
 
 #ifdef DLINK_MULTITHREADING
 #	include <mutex>
 #endif
 
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#if defined(DLINK_X86) && defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#endif
+
 namespace dlink
 {
 	dlink::endian get_endian()
@@ -36,4 +53,230 @@ namespace dlink
 
 		return endian;
 	}
+
+	instruction_set get_instruction_set() noexcept
+	{
+		static const instruction_set result = []
+		{
+#if defined(DLINK_X86) && defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+
+			__cpuid(info, 0);
+			const int max_leaf = info[0];
+
+			__cpuid(info, 1);
+			const bool ssse3 = (info[2] & (1 << 9)) != 0;
+			const bool sse42 = (info[2] & (1 << 20)) != 0;
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+
+			if (max_leaf >= 7 && osxsave && avx)
+			{
+				const unsigned long long xcr0 = _xgetbv(0);
+
+				__cpuidex(info, 7, 0);
+				const bool avx2 = (info[1] & (1 << 5)) != 0;
+				const bool avx512f = (info[1] & (1 << 16)) != 0;
+				const bool avx512bw = (info[1] & (1 << 30)) != 0;
+
+				if (avx512f && avx512bw && (xcr0 & 0xE6) == 0xE6) return instruction_set::avx512;
+				else if (avx2 && (xcr0 & 0x06) == 0x06) return instruction_set::avx2;
+			}
+
+			if (ssse3 && sse42) return instruction_set::sse42;
+#elif defined(DLINK_X86)
+			__builtin_cpu_init();
+
+			if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return instruction_set::avx512;
+			else if (__builtin_cpu_supports("avx2")) return instruction_set::avx2;
+			else if (__builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.2")) return instruction_set::sse42;
+#endif
+
+			return instruction_set::none;
+		}();
+
+		return result;
+	}
+}
+
+namespace dlink
+{
+	std::uint64_t get_file_size(const std::string& path) noexcept
+	{
+#if defined(_WIN32)
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes)) return 0;
+
+		return (static_cast<std::uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+#elif defined(__unix__) || defined(__APPLE__)
+		struct stat file_stat;
+		if (stat(path.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) return 0;
+
+		return static_cast<std::uint64_t>(file_stat.st_size);
+#else
+		static_cast<void>(path);
+		return 0;
+#endif
+	}
+
+	mapped_file::mapped_file(mapped_file&& file) noexcept
+		: data_(file.data_), size_(file.size_), released_(file.released_)
+	{
+		file.data_ = nullptr;
+		file.size_ = 0;
+		file.released_ = 0;
+	}
+	mapped_file::~mapped_file()
+	{
+		close();
+	}
+
+	mapped_file& mapped_file::operator=(mapped_file&& file) noexcept
+	{
+		if (this != &file)
+		{
+			close();
+
+			data_ = std::exchange(file.data_, nullptr);
+			size_ = std::exchange(file.size_, 0);
+			released_ = std::exchange(file.released_, 0);
+		}
+
+		return *this;
+	}
+
+	bool mapped_file::open(const std::string& path)
+	{
+		close();
+
+		// Only non-empty regular files are mapped. Everything else (empty files, pipes, devices and
+		// files on filesystems that refuse mmap) makes this function fail, so the caller can fall back to
+		// reading the file into an owned buffer.
+#if defined(_WIN32)
+		const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+										FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER file_size;
+		if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (mapping == nullptr) return false;
+
+		const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (view == nullptr) return false;
+
+		data_ = static_cast<const char*>(view);
+		size_ = static_cast<std::size_t>(file_size.QuadPart);
+
+		return true;
+#elif defined(__unix__) || defined(__APPLE__)
+		const int file = ::open(path.c_str(), O_RDONLY);
+		if (file == -1) return false;
+
+		struct stat file_stat;
+		if (fstat(file, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || file_stat.st_size <= 0)
+		{
+			::close(file);
+			return false;
+		}
+
+		const std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+		void* const view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (view == MAP_FAILED) return false;
+
+#	ifdef POSIX_MADV_SEQUENTIAL
+		posix_madvise(view, file_size, POSIX_MADV_SEQUENTIAL);
+#	endif
+
+		data_ = static_cast<const char*>(view);
+		size_ = file_size;
+
+		return true;
+#else
+		static_cast<void>(path);
+		return false;
+#endif
+	}
+	void mapped_file::close() noexcept
+	{
+		if (!data_) return;
+
+#if defined(_WIN32)
+		UnmapViewOfFile(data_);
+#elif defined(__unix__) || defined(__APPLE__)
+		munmap(const_cast<char*>(data_), size_);
+#endif
+
+		data_ = nullptr;
+		size_ = 0;
+		released_ = 0;
+	}
+	bool mapped_file::is_open() const noexcept
+	{
+		return data_ != nullptr;
+	}
+	void mapped_file::prefetch() const noexcept
+	{
+		static constexpr std::size_t page_size = 4096;
+
+		// Touching one byte per page makes the caller's thread wait for the I/O instead of the thread that decodes.
+		volatile char sink = 0;
+
+		for (std::size_t i = 0; i < size_; i += page_size)
+		{
+			sink = data_[i];
+		}
+
+		static_cast<void>(sink);
+	}
+	void mapped_file::release(std::size_t length) noexcept
+	{
+		static const std::size_t page_size = []() -> std::size_t
+		{
+#if defined(_WIN32)
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return info.dwPageSize;
+#elif defined(__unix__) || defined(__APPLE__)
+			const long size = sysconf(_SC_PAGESIZE);
+			return size > 0 ? static_cast<std::size_t>(size) : 4096;
+#else
+			return 4096;
+#endif
+		}();
+
+		// The view begins at a page boundary, so the pages are the ones below the last boundary before 'length'.
+		const std::size_t end = std::min(length, size_) / page_size * page_size;
+		if (!data_ || end <= released_) return;
+
+		char* const begin = const_cast<char*>(data_) + released_;
+
+		// The pages are read-only and never dirty, so dropping them loses nothing.
+#if defined(_WIN32)
+		VirtualUnlock(begin, end - released_);
+#elif defined(MADV_DONTNEED)
+		madvise(begin, end - released_, MADV_DONTNEED);
+#else
+		static_cast<void>(begin);
+#endif
+
+		released_ = end;
+	}
+
+	const char* mapped_file::data() const noexcept
+	{
+		return data_;
+	}
+	std::size_t mapped_file::size() const noexcept
+	{
+		return size_;
+	}
 }
\ No newline at end of file
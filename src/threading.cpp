@@ -1,13 +1,43 @@
 #include <Dlink/threading.hpp>
 
+#include <Dlink/exception.hpp>
+#include <Dlink/system.hpp>
+
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
 #include <thread>
+#include <utility>
 
 namespace dlink
 {
+	namespace
+	{
+		namespace scheduling
+		{
+			// Small jobs are batched until a task has this many bytes, or a share of the stage small enough that there
+			// are still a few tasks for every thread.
+			constexpr std::uint64_t min_task_size = 64 * 1024;
+			constexpr std::size_t min_tasks_per_thread = 4;
+		}
+
+		namespace pooling
+		{
+			// The pool the current thread works for, and the index of its queue there.
+			thread_local const thread_pool* current_pool = nullptr;
+			thread_local std::size_t current_queue = 0;
+		}
+	}
+
 	threading_info get_threading_info(const compiler_metadata& metadata)
 	{
-		const std::size_t input_files_size = metadata.options().input_files().size();
+		return get_threading_info(metadata, metadata.options().input_files().size());
+	}
+	threading_info get_threading_info(const compiler_metadata& metadata, std::size_t count_of_jobs)
+	{
 		std::size_t count_of_threads = metadata.options().count_of_threads();
 
 		if (count_of_threads == 0)
@@ -20,11 +50,494 @@ namespace dlink
 			}
 		}
 
-		count_of_threads = std::min(count_of_threads, input_files_size);
+		count_of_threads = std::min(count_of_threads, count_of_jobs);
+		if (count_of_threads == 0)
+			return {};
+
+		threading_info result;
+		result.average = count_of_jobs / count_of_threads;
+		result.remainder = count_of_jobs % count_of_threads;
+		result.count_of_threads = count_of_threads;
+
+		return result;
+	}
+	threading_info get_threading_info(const compiler_metadata& metadata, const std::vector<std::uint64_t>& sizes)
+	{
+		threading_info result = get_threading_info(metadata, sizes.size());
+		if (result.count_of_threads == 0)
+			return result;
+
+		result.order.resize(sizes.size());
+		std::iota(result.order.begin(), result.order.end(), 0);
+		// A single thread gains nothing from the order, so it keeps that of the jobs and reports in it.
+		if (result.count_of_threads > 1)
+		{
+			std::stable_sort(result.order.begin(), result.order.end(), [&sizes](std::size_t lhs, std::size_t rhs)
+			{
+				return sizes[lhs] > sizes[rhs];
+			});
+		}
+
+		result.size = std::accumulate(sizes.begin(), sizes.end(), std::uint64_t(0));
 
-		const std::size_t average = input_files_size / count_of_threads;
-		const std::size_t remainder = input_files_size % count_of_threads;
+		const std::uint64_t max_batch_size = std::clamp<std::uint64_t>(
+			result.size / (result.count_of_threads * scheduling::min_tasks_per_thread), 1, scheduling::min_task_size);
+		std::uint64_t task_size = 0;
+
+		for (std::size_t i = 0; i < result.order.size(); ++i)
+		{
+			task_size += sizes[result.order[i]];
+
+			if (task_size >= max_batch_size || i + 1 == result.order.size())
+			{
+				result.task_ends.push_back(i + 1);
+				task_size = 0;
+			}
+		}
+
+		// Tasks are handed out largest first to whichever thread is least loaded, which is what the pool does as long as
+		// every byte costs the same.
+		std::priority_queue<std::uint64_t, std::vector<std::uint64_t>, std::greater<std::uint64_t>> loads;
+		for (std::size_t i = 0; i < result.count_of_threads; ++i)
+		{
+			loads.push(0);
+		}
+
+		for (std::size_t task = 0; task < result.task_ends.size(); ++task)
+		{
+			std::uint64_t load = loads.top();
+			loads.pop();
+
+			for (std::size_t i = task == 0 ? 0 : result.task_ends[task - 1]; i < result.task_ends[task]; ++i)
+			{
+				load += sizes[result.order[i]];
+			}
+
+			result.predicted_size = std::max(result.predicted_size, load);
+			loads.push(load);
+		}
+
+		return result;
+	}
+	threading_info get_threading_info(const compiler_metadata& metadata, const std::vector<source>& sources, std::size_t offset)
+	{
+		std::vector<std::uint64_t> sizes;
+		sizes.reserve(sources.size() - std::min(offset, sources.size()));
+
+		for (std::size_t i = offset; i < sources.size(); ++i)
+		{
+			const source& source = sources[i];
+			sizes.push_back(source.state() >= source_state::decoded ? source.codes().size() : get_file_size(source.path()));
+		}
+
+		return get_threading_info(metadata, sizes);
+	}
+	void record_schedule(compiler_metadata& metadata, const char* stage, const threading_info& info,
+						 std::chrono::steady_clock::duration actual_makespan, std::chrono::steady_clock::duration busy_time)
+	{
+		using seconds = std::chrono::duration<double>;
+
+		stage_schedule schedule;
+		schedule.stage = stage;
+		schedule.count_of_threads = info.count_of_threads;
+		schedule.count_of_tasks = info.order.empty() ? info.count_of_threads * info.average + info.remainder : info.task_ends.size();
+		schedule.size = info.size;
+		schedule.predicted_size = info.predicted_size;
+		schedule.actual_makespan = std::chrono::duration_cast<seconds>(actual_makespan).count();
+		schedule.busy_time = std::chrono::duration_cast<seconds>(busy_time).count();
+		schedule.predicted_makespan = info.size == 0 ? schedule.busy_time / std::max<std::size_t>(info.count_of_threads, 1) :
+			schedule.busy_time * static_cast<double>(info.predicted_size) / static_cast<double>(info.size);
+
+		metadata.add_schedule(std::move(schedule));
+	}
+
+	thread_local thread_pool::batch_* thread_pool::current_batch_ = nullptr;
+
+	thread_pool::thread_pool(std::size_t count_of_workers)
+		: queues_(new queue_[max_count_of_workers + 1]), queued_(new std::atomic<std::size_t>[max_count_of_workers + 1])
+	{
+		for (std::size_t i = 0; i <= max_count_of_workers; ++i)
+		{
+			queued_[i].store(0, std::memory_order_relaxed);
+		}
+
+		reserve(count_of_workers);
+	}
+	thread_pool::~thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			stopped_ = true;
+		}
 
-		return { average, remainder, count_of_threads };
+		condition_.notify_all();
+
+		for (std::thread& worker : workers_)
+		{
+			worker.join();
+		}
+	}
+
+	void thread_pool::reserve(std::size_t count_of_workers)
+	{
+		count_of_workers = std::min(count_of_workers, max_count_of_workers);
+
+		std::lock_guard<std::mutex> guard(mutex_);
+
+		while (workers_.size() < count_of_workers)
+		{
+			workers_.emplace_back(&thread_pool::work_, this, workers_.size() + 1);
+		}
+
+		count_of_queues_.store(workers_.size() + 1, std::memory_order_release);
+	}
+	std::size_t thread_pool::count_of_workers() const noexcept
+	{
+		return count_of_queues_.load(std::memory_order_acquire) - 1;
+	}
+
+	thread_pool& thread_pool::shared(std::size_t count_of_threads)
+	{
+		static thread_pool pool(0);
+
+		if (count_of_threads > pool.count_of_workers() + 1)
+		{
+			pool.reserve(count_of_threads - 1);
+		}
+
+		return pool;
+	}
+
+	void thread_pool::ready(std::size_t index)
+	{
+		if (!current_batch_)
+			throw invalid_state("There must be a task of a pool running on the calling thread when 'void dlink::thread_pool::ready(std::size_t)' method is called.");
+
+		push_(*current_batch_, index, 1, nullptr);
+	}
+
+	bool thread_pool::run_(batch_& batch, std::size_t begin, std::size_t end, std::size_t count_of_threads)
+	{
+		if (begin >= end)
+			return true;
+
+		batch.count_of_threads = std::clamp<std::size_t>(count_of_threads, 1, count_of_queues_.load(std::memory_order_acquire));
+		batch.pending.store(end - begin, std::memory_order_relaxed);
+		push_(batch, begin, end - begin, nullptr);
+
+		return wait_(batch);
+	}
+	bool thread_pool::run_(batch_& batch, std::size_t count_of_tasks, const std::vector<std::size_t>& ready_tasks, std::size_t count_of_threads)
+	{
+		if (count_of_tasks == 0)
+			return true;
+
+		batch.count_of_threads = std::clamp<std::size_t>(count_of_threads, 1, count_of_queues_.load(std::memory_order_acquire));
+		batch.pending.store(count_of_tasks, std::memory_order_relaxed);
+		push_(batch, 0, ready_tasks.size(), ready_tasks.data());
+
+		return wait_(batch);
+	}
+	void thread_pool::push_(batch_& batch, std::size_t begin, std::size_t count, const std::size_t* indices)
+	{
+		const std::size_t self = pooling::current_pool == this ? pooling::current_queue : 0;
+		const std::size_t count_of_threads = batch.count_of_threads;
+
+		// A worker keeps the tasks it queues to itself and leaves them to the others to steal. Otherwise the tasks are
+		// dealt out to the queues of the batch. Either way they are pushed backwards, so the owner of a queue takes them
+		// in order.
+		for (std::size_t i = count; i-- > 0;)
+		{
+			queue_& queue = queues_[self != 0 ? self : i % count_of_threads];
+
+			std::lock_guard<std::mutex> guard(queue.mutex);
+			queue.tasks.push_back({ &batch, indices ? indices[i] : begin + i });
+		}
+
+		queued_[count_of_threads - 1].fetch_add(count, std::memory_order_release);
+
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+		}
+
+		// Every thread that sleeps wakes up for a task it may take, so one of them is enough for a single task that any
+		// thread may take.
+		if (count == 1 && count_of_threads == count_of_queues_.load(std::memory_order_acquire))
+		{
+			condition_.notify_one();
+		}
+		else
+		{
+			condition_.notify_all();
+		}
+	}
+	bool thread_pool::wait_(batch_& batch)
+	{
+		const std::size_t self = pooling::current_pool == this ? pooling::current_queue : 0;
+		// A worker outside the batch that runs it nested still takes part, in place of the last thread of the batch.
+		const std::size_t rank = std::min(self, batch.count_of_threads - 1);
+
+		while (batch.pending.load(std::memory_order_acquire) != 0)
+		{
+			task_ task;
+
+			if (take_(self, rank, task))
+			{
+				execute_(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this, &batch, rank]
+			{
+				return batch.pending.load(std::memory_order_acquire) == 0 || queued_for_(rank);
+			});
+		}
+
+		if (batch.exception)
+			std::rethrow_exception(batch.exception);
+
+		return batch.result.load(std::memory_order_relaxed);
+	}
+	void thread_pool::work_(std::size_t index)
+	{
+		pooling::current_pool = this;
+		pooling::current_queue = index;
+
+		while (true)
+		{
+			task_ task;
+
+			if (take_(index, index, task))
+			{
+				execute_(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this, index] { return stopped_ || queued_for_(index); });
+			if (stopped_) return;
+		}
+	}
+	bool thread_pool::take_(std::size_t index, std::size_t rank, task_& task)
+	{
+		if (!queued_for_(rank))
+			return false;
+
+		const auto runs = [rank](const task_& task) { return task.batch->count_of_threads > rank; };
+		const std::size_t count_of_queues = count_of_queues_.load(std::memory_order_acquire);
+
+		// The owner takes the newest task of its own queue and the others steal the oldest one.
+		for (std::size_t i = 0; i < count_of_queues; ++i)
+		{
+			queue_& queue = queues_[(index + i) % count_of_queues];
+			std::lock_guard<std::mutex> guard(queue.mutex);
+
+			if (i == 0)
+			{
+				const auto iter = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), runs);
+				if (iter == queue.tasks.rend())
+					continue;
+
+				task = *iter;
+				queue.tasks.erase(std::next(iter).base());
+			}
+			else
+			{
+				const auto iter = std::find_if(queue.tasks.begin(), queue.tasks.end(), runs);
+				if (iter == queue.tasks.end())
+					continue;
+
+				task = *iter;
+				queue.tasks.erase(iter);
+			}
+
+			queued_[task.batch->count_of_threads - 1].fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		return false;
+	}
+	bool thread_pool::queued_for_(std::size_t rank) const noexcept
+	{
+		const std::size_t count_of_queues = count_of_queues_.load(std::memory_order_acquire);
+
+		for (std::size_t i = rank; i < count_of_queues; ++i)
+		{
+			if (queued_[i].load(std::memory_order_acquire) != 0)
+				return true;
+		}
+
+		return false;
+	}
+	void thread_pool::execute_(const task_& task)
+	{
+		batch_& batch = *task.batch;
+		batch_* const outer_batch = std::exchange(current_batch_, &batch);
+
+		try
+		{
+			if (!batch.invoke(batch.function, task.index))
+			{
+				batch.result.store(false, std::memory_order_relaxed);
+			}
+		}
+		catch (...)
+		{
+			if (!batch.failed.exchange(true, std::memory_order_relaxed))
+			{
+				batch.exception = std::current_exception();
+			}
+		}
+
+		current_batch_ = outer_batch;
+
+		// The thread that runs the batch may return as soon as it sees the last task done, so the batch isn't touched after.
+		if (batch.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			{
+				std::lock_guard<std::mutex> guard(mutex_);
+			}
+
+			condition_.notify_all();
+		}
+	}
+
+	std::size_t task_graph::add(std::function<bool()> function)
+	{
+		nodes_.emplace_back().function = std::move(function);
+
+		return nodes_.size() - 1;
+	}
+	void task_graph::depend(std::size_t task, std::size_t dependency)
+	{
+		if (task >= nodes_.size())
+			throw std::out_of_range("The argument 'task' is out of range.");
+		else if (dependency >= task)
+			throw std::invalid_argument("The argument 'dependency' must be a task added before the argument 'task'.");
+
+		nodes_[dependency].dependents.push_back(task);
+		++nodes_[task].count_of_dependencies;
+	}
+	bool task_graph::run(thread_pool& pool, std::size_t count_of_threads)
+	{
+		std::vector<std::size_t> ready_tasks;
+
+		for (std::size_t i = 0; i < nodes_.size(); ++i)
+		{
+			node_& node = nodes_[i];
+			node.remaining.store(node.count_of_dependencies, std::memory_order_relaxed);
+			node.skipped.store(false, std::memory_order_relaxed);
+
+			if (node.count_of_dependencies == 0)
+			{
+				ready_tasks.push_back(i);
+			}
+		}
+
+		return pool.run([this, &pool](std::size_t index) -> bool
+		{
+			node_& node = nodes_[index];
+			bool result = false;
+
+			try
+			{
+				result = !node.skipped.load(std::memory_order_relaxed) && node.function();
+			}
+			catch (...)
+			{
+				finish_(pool, node, false);
+				throw;
+			}
+
+			finish_(pool, node, result);
+			return result;
+		}, nodes_.size(), ready_tasks, count_of_threads);
+	}
+	std::size_t task_graph::size() const noexcept
+	{
+		return nodes_.size();
+	}
+
+	void task_graph::finish_(thread_pool& pool, node_& node, bool result)
+	{
+		for (std::size_t dependent : node.dependents)
+		{
+			node_& next = nodes_[dependent];
+
+			if (!result)
+			{
+				next.skipped.store(true, std::memory_order_relaxed);
+			}
+
+			// The last dependency to finish queues the task, and its release makes the skip visible to it.
+			if (next.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				pool.ready(dependent);
+			}
+		}
+	}
+
+	read_ahead::read_ahead(const std::vector<std::string>& paths, bool map_input, std::size_t depth)
+		: paths_(paths), map_input_(map_input), depth_(std::max<std::size_t>(depth, 1)),
+		inputs_(paths.size()), ready_(paths.size(), false)
+	{
+		const std::size_t count_of_readers = std::min(max_count_of_readers, paths.size());
+
+		for (std::size_t i = 0; i < count_of_readers; ++i)
+		{
+			readers_.emplace_back(&read_ahead::read_, this);
+		}
+	}
+	read_ahead::~read_ahead()
+	{
+		{
+			std::lock_guard<std::mutex> guard(mutex_);
+			stopped_ = true;
+		}
+
+		condition_.notify_all();
+
+		for (std::thread& reader : readers_)
+		{
+			reader.join();
+		}
+	}
+
+	raw_input read_ahead::take(std::size_t index)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		condition_.wait(lock, [this, index] { return ready_[index]; });
+
+		++taken_;
+		condition_.notify_all();
+
+		return std::move(inputs_[index]);
+	}
+
+	void read_ahead::read_()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		while (true)
+		{
+			// At most depth_ files are read but not yet taken, so memory stays bounded when reading outpaces compiling.
+			condition_.wait(lock, [this] { return stopped_ || next_ >= paths_.size() || next_ - taken_ < depth_; });
+			if (stopped_ || next_ >= paths_.size()) return;
+
+			const std::size_t index = next_++;
+			lock.unlock();
+
+			raw_input input = decoder::read_source(paths_[index], map_input_);
+			if (input.mapping.is_open())
+			{
+				input.mapping.prefetch();
+			}
+
+			lock.lock();
+			inputs_[index] = std::move(input);
+			ready_[index] = true;
+			condition_.notify_all();
+		}
 	}
 }
\ No newline at end of file
@@ -1,12 +1,68 @@
 #include <Dlink/token.hpp>
 
+#include <Dlink/encoding.hpp>
+
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <map>
-#include <unordered_map>
 #include <utility>
 
 namespace dlink
 {
+	// Every operator and punctuator the lexer produces, with its spelling. The operator trie of the lexer, to_token_type and
+	// to_string are all derived from this list.
+#define DLINK_OPERATORS(X) \
+	X(plus, "+") \
+	X(increment, "++") \
+	X(plus_assign, "+=") \
+	X(minus, "-") \
+	X(decrement, "--") \
+	X(minus_assign, "-=") \
+	X(multiply, "*") \
+	X(multiply_assign, "*=") \
+	X(divide, "/") \
+	X(divide_assign, "/=") \
+	X(modulo, "%") \
+	X(modulo_assign, "%=") \
+	X(exp, "**") \
+	X(exp_assign, "**=") \
+	X(assign, "=") \
+	X(equal, "==") \
+	X(equal_not, "!=") \
+	X(greater, ">") \
+	X(equal_greater, ">=") \
+	X(less, "<") \
+	X(equal_less, "<=") \
+	X(logic_and, "&&") \
+	X(logic_or, "||") \
+	X(bit_not, "~") \
+	X(bit_and, "&") \
+	X(bit_and_assign, "&=") \
+	X(bit_or, "|") \
+	X(bit_or_assign, "|=") \
+	X(bit_xor, "^") \
+	X(bit_xor_assign, "^=") \
+	X(bit_shift_left, "<<") \
+	X(bit_shift_left_assign, "<<=") \
+	X(bit_shift_right, ">>") \
+	X(bit_shift_right_assign, ">>=") \
+	X(rightwards_arrow, "->") \
+	X(rightwards_double_arrow, "=>") \
+	X(brace_left, "{") \
+	X(brace_right, "}") \
+	X(paren_left, "(") \
+	X(paren_right, ")") \
+	X(big_paren_left, "[") \
+	X(big_paren_right, "]") \
+	X(dot, ".") \
+	X(comma, ",") \
+	X(semicolon, ";") \
+	X(colon, ":") \
+	X(exclamation, "!") \
+	X(question, "?") \
+	X(dollar, "$")
+
 #define MAP_TOKEN(token) std::pair<token_type, std::string_view>(token_type:: token , #token)
 
 	namespace
@@ -27,69 +83,11 @@ namespace dlink
 			MAP_TOKEN(character),
 			MAP_TOKEN(string),
 
-			MAP_TOKEN(plus),
-			MAP_TOKEN(increment),
-			MAP_TOKEN(plus_assign),
-
-			MAP_TOKEN(minus),
-			MAP_TOKEN(decrement),
-			MAP_TOKEN(minus_assign),
-
-			MAP_TOKEN(multiply),
-			MAP_TOKEN(multiply_assign),
-
-			MAP_TOKEN(divide),
-			MAP_TOKEN(divide_assign),
-
-			MAP_TOKEN(modulo),
-			MAP_TOKEN(modulo_assign),
-
-			MAP_TOKEN(exp),
-			MAP_TOKEN(exp_assign),
-
-			MAP_TOKEN(assign),
-			MAP_TOKEN(equal),
-			MAP_TOKEN(equal_not),
-			MAP_TOKEN(greater),
-			MAP_TOKEN(equal_greater),
-			MAP_TOKEN(less),
-			MAP_TOKEN(equal_less),
-
-			MAP_TOKEN(logic_and),
-			MAP_TOKEN(logic_or),
-
-			MAP_TOKEN(bit_not),
-			MAP_TOKEN(bit_and),
-			MAP_TOKEN(bit_and_assign),
-			MAP_TOKEN(bit_or),
-			MAP_TOKEN(bit_or_assign),
-			MAP_TOKEN(bit_xor),
-			MAP_TOKEN(bit_xor_assign),
-			MAP_TOKEN(bit_shift_left),
-			MAP_TOKEN(bit_shift_left_assign),
-			MAP_TOKEN(bit_shift_right),
-			MAP_TOKEN(bit_shift_right_assign),
-
-			MAP_TOKEN(rightwards_arrow),
-			MAP_TOKEN(rightwards_double_arrow),
-
-			MAP_TOKEN(brace_left),
-			MAP_TOKEN(brace_right),
-			MAP_TOKEN(paren_left),
-			MAP_TOKEN(paren_right),
-			MAP_TOKEN(big_paren_left),
-			MAP_TOKEN(big_paren_right),
-
-			MAP_TOKEN(dot),
-			MAP_TOKEN(comma),
-			MAP_TOKEN(apostrophe),
-			MAP_TOKEN(semicolon),
-			MAP_TOKEN(colon),
-
-			MAP_TOKEN(exclamation),
-			MAP_TOKEN(question),
+#define MAP_OPERATOR(token, spelling) MAP_TOKEN(token),
+			DLINK_OPERATORS(MAP_OPERATOR)
+#undef MAP_OPERATOR
 
-			MAP_TOKEN(dollar),
+			MAP_TOKEN(apostrophe),
 			MAP_TOKEN(at),
 
 			MAP_TOKEN(keyword_auto),
@@ -221,10 +219,94 @@ namespace dlink
 		'/',
 	};
 
-	bool is_special_character(char character)
+	namespace
 	{
-		return std::find(special_characters.begin(), special_characters.end(), character) !=
-			special_characters.end();
+		namespace operator_matching
+		{
+			struct spelling
+			{
+				token_type type;
+				std::string_view spelling;
+			};
+
+#define MAP_OPERATOR(token, spelling) { token_type:: token, spelling },
+			constexpr spelling spellings[] =
+			{
+				DLINK_OPERATORS(MAP_OPERATOR)
+			};
+#undef MAP_OPERATOR
+
+			constexpr std::size_t alphabet_size = 128;
+
+			// Node 0 is the root, so a child of 0 means there is none.
+			struct node
+			{
+				token_type type = token_type::none;
+				bool leaf = true;
+				std::array<std::uint8_t, alphabet_size> next{};
+			};
+
+			constexpr std::size_t count_nodes() noexcept
+			{
+				std::size_t result = 1;
+
+				for (const spelling& spelling : spellings)
+				{
+					result += spelling.spelling.size();
+				}
+
+				return result;
+			}
+			constexpr std::size_t max_length() noexcept
+			{
+				std::size_t result = 0;
+
+				for (const spelling& spelling : spellings)
+				{
+					result = std::max(result, spelling.spelling.size());
+				}
+
+				return result;
+			}
+
+			constexpr std::array<node, count_nodes()> build_trie() noexcept
+			{
+				std::array<node, count_nodes()> result{};
+				std::size_t size = 1;
+
+				for (const spelling& spelling : spellings)
+				{
+					std::size_t current = 0;
+
+					for (const char c : spelling.spelling)
+					{
+						std::uint8_t& next = result[current].next[static_cast<unsigned char>(c)];
+
+						if (!next)
+						{
+							next = static_cast<std::uint8_t>(size++);
+						}
+
+						result[current].leaf = false;
+						current = next;
+					}
+
+					result[current].type = spelling.type;
+				}
+
+				return result;
+			}
+
+			constexpr std::array<node, count_nodes()> trie = build_trie();
+
+			static_assert(count_nodes() <= 256, "The nodes of the operator trie must be numbered by a byte.");
+			static_assert(max_length() == max_operator_length, "'dlink::max_operator_length' must be the length of the longest operator.");
+		}
+	}
+
+	bool is_special_character(char character) noexcept
+	{
+		return classify(character) & character_class::special;
 	}
 	bool is_valid_special_character(char character) noexcept
 	{
@@ -244,196 +326,51 @@ namespace dlink
 	}
 	token_type to_token_type(char valid_special_character) noexcept
 	{
-		static std::unordered_map<char, token_type> map =
-		{
-#define MAP_TOKEN(sc, type) { sc, token_type::type }
-			MAP_TOKEN('~', bit_not),
-			MAP_TOKEN('!', exclamation),
-			MAP_TOKEN('$', dollar),
-			MAP_TOKEN('%', modulo),
-			MAP_TOKEN('^', bit_xor),
-			MAP_TOKEN('&', bit_and),
-			MAP_TOKEN('*', multiply),
-			MAP_TOKEN('(', paren_left),
-			MAP_TOKEN(')', paren_right),
-			MAP_TOKEN('-', minus),
-			MAP_TOKEN('+', plus),
-			MAP_TOKEN('=', assign),
-			MAP_TOKEN('|', bit_or),
-			MAP_TOKEN('{', brace_left),
-			MAP_TOKEN('[', big_paren_left),
-			MAP_TOKEN('}', brace_right),
-			MAP_TOKEN(']', big_paren_right),
-			MAP_TOKEN(':', colon),
-			MAP_TOKEN(';', semicolon),
-			MAP_TOKEN('<', less),
-			MAP_TOKEN(',', comma),
-			MAP_TOKEN('>', greater),
-			MAP_TOKEN('.', dot),
-			MAP_TOKEN('?', question),
-			MAP_TOKEN('/', divide),
-#undef MAP_TOKEN
-		};
+		token_type type = token_type::none;
+		match_operator(&valid_special_character, &valid_special_character + 1, type);
 
-		return map[valid_special_character];
+		return type;
 	}
 	bool is_single_special_character(char valid_special_character) noexcept
 	{
-		switch (valid_special_character)
-		{
-		case '~':
-		case '$':
-		case '(':
-		case ')':
-		case '{':
-		case '[':
-		case '}':
-		case ']':
-		case ':':
-		case ';':
-		case ',':
-		case '.':
-		case '?':
-			return true;
+		const unsigned char c = static_cast<unsigned char>(valid_special_character);
 
-		default:
-			return false;
-		}
+		return c < operator_matching::alphabet_size && operator_matching::trie[operator_matching::trie[0].next[c]].leaf;
 	}
-	token_type complex_token_type(token_type type, char valid_special_character) noexcept
+	std::size_t match_operator(const char* begin, const char* end, token_type& type) noexcept
 	{
-		switch (type)
-		{
-		case token_type::exclamation:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::equal_not;
-			default: return type;
-			}
-
-		case token_type::modulo:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::modulo_assign;
-			default: return type;
-			}
+		std::size_t length = 0;
+		std::uint8_t node = 0;
 
-		case token_type::bit_xor:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::bit_xor_assign;
-			default: return type;
-			}
-
-		case token_type::bit_and:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::bit_and_assign;
-			case '&': return token_type::logic_and;
-			default: return type;
-			}
-
-		case token_type::multiply:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::multiply_assign;
-			case '*': return token_type::exp;
-			default: return type;
-			}
-
-		case token_type::minus:
-			switch (valid_special_character)
-			{
-			case '-': return token_type::decrement;
-			case '=': return token_type::minus_assign;
-			case '>': return token_type::rightwards_arrow;
-			default: return type;
-			}
-
-		case token_type::plus:
-			switch (valid_special_character)
-			{
-			case '+': return token_type::increment;
-			case '=': return token_type::plus_assign;
-			case '>': return token_type::rightwards_double_arrow;
-			default: return type;
-			}
-
-		case token_type::assign:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::equal;
-			default: return type;
-			}
-
-		case token_type::bit_or:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::bit_or_assign;
-			case '|': return token_type::logic_or;
-			default: return type;
-			}
-
-		case token_type::less:
-			switch (valid_special_character)
-			{
-			case '<': return token_type::bit_shift_left;
-			default: return type;
-			}
-
-		case token_type::greater:
-			switch (valid_special_character)
-			{
-			case '>': return token_type::bit_shift_right;
-			default: return type;
-			}
-
-		case token_type::divide:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::divide_assign;
-			default: return type;
-			}
-
-		case token_type::exp:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::exp_assign;
-			default: return type;
-			}
-
-		case token_type::bit_shift_left:
-			switch (valid_special_character)
-			{
-			case '=': return token_type::bit_shift_left_assign;
-			default: return type;
-			}
+		// The longest match is the last operator passed on the way down, so nothing is read twice.
+		for (const char* current = begin; current < end; ++current)
+		{
+			const unsigned char c = static_cast<unsigned char>(*current);
+			if (c >= operator_matching::alphabet_size || !(node = operator_matching::trie[node].next[c])) break;
 
-		case token_type::bit_shift_right:
-			switch (valid_special_character)
+			if (const token_type node_type = operator_matching::trie[node].type; node_type != token_type::none)
 			{
-			case '=': return token_type::bit_shift_right_assign;
-			default: return type;
+				type = node_type;
+				length = static_cast<std::size_t>(current - begin) + 1;
 			}
-
-		default:
-			return type;
 		}
+
+		return length;
 	}
 }
 
 namespace dlink
 {
-	token::token(const std::string_view& data, token_type type, std::size_t line, std::size_t col, const std::string_view& line_data)
-		: data_(data), type_(type), line_(line), col_(col), line_data_(line_data)
+	token::token(const std::string_view& data, token_type type, std::size_t offset)
+		: data_(data), type_(type), offset_(offset)
 	{}
-	token::token(const std::string_view& data, token_type type, std::size_t line, std::size_t col, const std::string_view& line_data,
+	token::token(const std::string_view& data, token_type type, std::size_t offset,
 		const std::string_view& prefix_literal, const std::string_view& postfix_literal)
-		: data_(data), type_(type), line_(line), col_(col), line_data_(line_data),
+		: data_(data), type_(type), offset_(offset),
 		prefix_literal_(prefix_literal), postfix_literal_(postfix_literal)
 	{}
 	token::token(const token& token)
-		: data_(token.data_), type_(token.type_), line_(token.line_), col_(token.col_), line_data_(token.line_data_),
+		: data_(token.data_), type_(token.type_), offset_(token.offset_),
 		prefix_literal_(token.prefix_literal_), postfix_literal_(token.postfix_literal_)
 	{}
 
@@ -441,9 +378,7 @@ namespace dlink
 	{
 		data_ = token.data_;
 		type_ = token.type_;
-		line_ = token.line_;
-		col_ = token.col_;
-		line_data_ = token.line_data_;
+		offset_ = token.offset_;
 		prefix_literal_ = token.prefix_literal_;
 		postfix_literal_ = token.postfix_literal_;
 
@@ -454,45 +389,35 @@ namespace dlink
 	{
 		data_ = "";
 		type_ = token_type::none;
-		line_ = 0;
-		col_ = 0;
-		line_data_ = "";
+		offset_ = 0;
 		prefix_literal_ = "";
 		postfix_literal_ = "";
 	}
 	bool token::empty() const noexcept
 	{
 		return data_.empty() && type_ == token_type::none &&
-			line_ == 0 && col_ == 0 && prefix_literal_.empty() && prefix_literal_.empty();
+			offset_ == 0 && prefix_literal_.empty() && prefix_literal_.empty();
 	}
 
-	nlohmann::json token::dump() const
+	nlohmann::json token::dump(const line_index& lines) const
 	{
 		nlohmann::json object;
 
 		object["data"] = data_;
-		object["location"] = { { "line", line_ }, { "col", col_ } };
+		object["location"] = { { "line", lines.line(offset_) }, { "col", lines.col(offset_) } };
 		object["type"] = to_string(type_);
 		object["literal"] = { { "prefix", prefix_literal_ }, { "postfix", postfix_literal_ } };
 
 		return object;
 	}
 
-	std::size_t token::line() const noexcept
-	{
-		return line_;
-	}
-	void token::line(std::size_t new_line) noexcept
+	std::size_t token::offset() const noexcept
 	{
-		line_ = new_line;
+		return offset_;
 	}
-	std::size_t token::col() const noexcept
+	void token::offset(std::size_t new_offset) noexcept
 	{
-		return col_;
-	}
-	void token::col(std::size_t new_col) noexcept
-	{
-		col_ = new_col;
+		offset_ = new_offset;
 	}
 	token_type token::type() const noexcept
 	{
@@ -510,14 +435,6 @@ namespace dlink
 	{
 		data_ = new_data;
 	}
-	const std::string_view& token::line_data() const noexcept
-	{
-		return line_data_;
-	}
-	void token::line_data(const std::string_view& new_line_data) noexcept
-	{
-		line_data_ = new_line_data;
-	}
 	const std::string_view& token::prefix_literal() const noexcept
 	{
 		return prefix_literal_;
@@ -0,0 +1,374 @@
+#include <Dlink/token_buffer.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace dlink
+{
+	namespace
+	{
+		namespace token_splicing
+		{
+			// Replaces [begin, end) of 'vector' with [first, last), moving the elements after them only once.
+			template<typename Ty_, typename Iterator_>
+			void splice(std::vector<Ty_>& vector, std::size_t begin, std::size_t end, Iterator_ first, Iterator_ last)
+			{
+				const std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+
+				if (count > end - begin)
+				{
+					vector.insert(vector.begin() + end, count - (end - begin), Ty_());
+				}
+				else
+				{
+					vector.erase(vector.begin() + begin + count, vector.begin() + end);
+				}
+
+				std::copy(first, last, vector.begin() + begin);
+			}
+
+			// Replaces the entries of the tokens in [begin, end) with 'new_entries', whose indexes count from 'begin', and moves
+			// the indexes of the entries after them by 'index_delta'. Returns where the entries after them begin.
+			template<typename Entry_>
+			std::size_t splice_entries(std::vector<Entry_>& entries, std::size_t begin, std::size_t end,
+									   const std::vector<Entry_>& new_entries, std::ptrdiff_t index_delta)
+			{
+				const auto by_index = [](const Entry_& entry, std::size_t index)
+				{
+					return entry.index < index;
+				};
+
+				const std::size_t entries_begin = std::lower_bound(entries.begin(), entries.end(), begin, by_index) - entries.begin();
+				const std::size_t entries_end = std::lower_bound(entries.begin() + entries_begin, entries.end(), end, by_index) - entries.begin();
+				const std::size_t moved_begin = entries_begin + new_entries.size();
+
+				splice(entries, entries_begin, entries_end, new_entries.begin(), new_entries.end());
+
+				for (std::size_t i = entries_begin; i < moved_begin; ++i)
+				{
+					entries[i].index += static_cast<std::uint32_t>(begin);
+				}
+				for (std::size_t i = moved_begin; i < entries.size(); ++i)
+				{
+					entries[i].index = static_cast<std::uint32_t>(static_cast<std::ptrdiff_t>(entries[i].index) + index_delta);
+				}
+
+				return moved_begin;
+			}
+		}
+	}
+
+	static_assert(static_cast<std::size_t>(token_type::keyword_false) <= std::numeric_limits<std::uint8_t>::max(),
+				  "The types of tokens must fit in a byte of dlink::token_buffer.");
+
+	token_view::token_view(const token_buffer& buffer, std::size_t index) noexcept
+		: buffer_(&buffer), index_(index)
+	{}
+
+	bool token_view::empty() const noexcept
+	{
+		return data().empty() && type() == token_type::none &&
+			offset() == 0 && prefix_literal().empty() && postfix_literal().empty();
+	}
+	token token_view::to_token() const
+	{
+		return token(data(), type(), offset(), prefix_literal(), postfix_literal());
+	}
+
+	nlohmann::json token_view::dump(const line_index& lines) const
+	{
+		nlohmann::json object;
+
+		object["data"] = data();
+		object["location"] = { { "line", lines.line(offset()) }, { "col", lines.col(offset()) } };
+		object["type"] = to_string(type());
+		object["literal"] = { { "prefix", prefix_literal() }, { "postfix", postfix_literal() } };
+
+		return object;
+	}
+
+	std::size_t token_view::index() const noexcept
+	{
+		return index_;
+	}
+	std::size_t token_view::offset() const noexcept
+	{
+		return buffer_->offsets_[index_];
+	}
+	std::size_t token_view::end_offset() const noexcept
+	{
+		const token_buffer::literal_entry_* const literal = buffer_->find_literal_(index_);
+		if (!literal) return buffer_->offsets_[index_] + buffer_->lengths_[index_];
+
+		// Empty views are stored at 0, wherever they pointed.
+		std::size_t result = buffer_->offsets_[index_];
+
+		if (buffer_->lengths_[index_])
+		{
+			result = std::max<std::size_t>(result, literal->data_offset + buffer_->lengths_[index_]);
+		}
+		if (literal->prefix_length)
+		{
+			result = std::max<std::size_t>(result, literal->prefix_offset + literal->prefix_length);
+		}
+		if (literal->postfix_length)
+		{
+			result = std::max<std::size_t>(result, literal->postfix_offset + literal->postfix_length);
+		}
+
+		return result;
+	}
+	token_type token_view::type() const noexcept
+	{
+		return static_cast<token_type>(buffer_->types_[index_]);
+	}
+	std::string_view token_view::data() const noexcept
+	{
+		const token_buffer::literal_entry_* const literal = buffer_->find_literal_(index_);
+		const std::size_t data_offset = literal ? literal->data_offset : buffer_->offsets_[index_];
+
+		return buffer_->codes_.substr(data_offset, buffer_->lengths_[index_]);
+	}
+	std::string_view token_view::prefix_literal() const noexcept
+	{
+		const token_buffer::literal_entry_* const literal = buffer_->find_literal_(index_);
+		if (!literal || !literal->prefix_length) return std::string_view();
+
+		return buffer_->codes_.substr(literal->prefix_offset, literal->prefix_length);
+	}
+	std::string_view token_view::postfix_literal() const noexcept
+	{
+		const token_buffer::literal_entry_* const literal = buffer_->find_literal_(index_);
+		if (!literal || !literal->postfix_length) return std::string_view();
+
+		return buffer_->codes_.substr(literal->postfix_offset, literal->postfix_length);
+	}
+	const number_value* token_view::number() const noexcept
+	{
+		return buffer_->find_number_(index_);
+	}
+	dlink::symbol token_view::symbol() const noexcept
+	{
+		return buffer_->find_symbol_(index_);
+	}
+}
+
+namespace dlink
+{
+	token_buffer::const_iterator::const_iterator(const token_buffer& buffer, std::size_t index) noexcept
+		: buffer_(&buffer), index_(index)
+	{}
+
+	token_view token_buffer::const_iterator::operator*() const noexcept
+	{
+		return token_view(*buffer_, index_);
+	}
+	token_buffer::const_iterator& token_buffer::const_iterator::operator++() noexcept
+	{
+		++index_;
+		return *this;
+	}
+	token_buffer::const_iterator token_buffer::const_iterator::operator++(int) noexcept
+	{
+		const const_iterator result = *this;
+		++index_;
+		return result;
+	}
+	bool token_buffer::const_iterator::operator==(const const_iterator& iterator) const noexcept
+	{
+		return buffer_ == iterator.buffer_ && index_ == iterator.index_;
+	}
+	bool token_buffer::const_iterator::operator!=(const const_iterator& iterator) const noexcept
+	{
+		return !(*this == iterator);
+	}
+}
+
+namespace dlink
+{
+	token_buffer::token_buffer(const std::string_view& codes, const std::vector<token>& tokens)
+	{
+		this->codes(codes);
+		reserve(tokens.size());
+
+		for (const token& token : tokens)
+		{
+			push_back(token);
+		}
+	}
+
+	token_view token_buffer::operator[](std::size_t index) const noexcept
+	{
+		return token_view(*this, index);
+	}
+
+	void token_buffer::clear() noexcept
+	{
+		codes_ = std::string_view();
+		types_.clear();
+		offsets_.clear();
+		lengths_.clear();
+		literals_.clear();
+		numbers_.clear();
+		symbols_.clear();
+		comment_lines_.clear();
+	}
+	bool token_buffer::empty() const noexcept
+	{
+		return types_.empty();
+	}
+	std::size_t token_buffer::size() const noexcept
+	{
+		return types_.size();
+	}
+	void token_buffer::reserve(std::size_t new_capacity)
+	{
+		types_.reserve(new_capacity);
+		offsets_.reserve(new_capacity);
+		lengths_.reserve(new_capacity);
+	}
+	void token_buffer::push_back(const token& token)
+	{
+		const std::uint32_t index = static_cast<std::uint32_t>(types_.size());
+		const std::uint32_t offset = static_cast<std::uint32_t>(token.offset());
+		const std::uint32_t data_offset = to_offset_(token.data());
+
+		types_.push_back(static_cast<std::uint8_t>(token.type()));
+		offsets_.push_back(offset);
+		lengths_.push_back(static_cast<std::uint32_t>(token.data().size()));
+
+		const std::string_view& prefix_literal = token.prefix_literal();
+		const std::string_view& postfix_literal = token.postfix_literal();
+
+		if (!prefix_literal.empty() || !postfix_literal.empty() || data_offset != offset)
+		{
+			literals_.push_back({
+				index, data_offset,
+				to_offset_(prefix_literal), static_cast<std::uint32_t>(prefix_literal.size()),
+				to_offset_(postfix_literal), static_cast<std::uint32_t>(postfix_literal.size())
+				});
+		}
+	}
+	void token_buffer::push_back(const token& token, const number_value& value)
+	{
+		numbers_.push_back({ static_cast<std::uint32_t>(types_.size()), value });
+		push_back(token);
+	}
+	void token_buffer::push_back(const token& token, dlink::symbol symbol)
+	{
+		symbols_.push_back({ static_cast<std::uint32_t>(types_.size()), symbol });
+		push_back(token);
+	}
+
+	void token_buffer::splice(std::size_t begin, std::size_t end, const token_buffer& buffer, std::ptrdiff_t offset_delta)
+	{
+		const std::size_t count = buffer.size();
+		const std::ptrdiff_t index_delta = static_cast<std::ptrdiff_t>(count) - static_cast<std::ptrdiff_t>(end - begin);
+		const auto move = [offset_delta](std::uint32_t offset) noexcept
+		{
+			return static_cast<std::uint32_t>(static_cast<std::ptrdiff_t>(offset) + offset_delta);
+		};
+
+		token_splicing::splice(types_, begin, end, buffer.types_.begin(), buffer.types_.end());
+		token_splicing::splice(offsets_, begin, end, buffer.offsets_.begin(), buffer.offsets_.end());
+		token_splicing::splice(lengths_, begin, end, buffer.lengths_.begin(), buffer.lengths_.end());
+
+		for (std::size_t i = begin + count; i < offsets_.size(); ++i)
+		{
+			offsets_[i] = move(offsets_[i]);
+		}
+
+		const std::size_t moved_literals_begin = token_splicing::splice_entries(literals_, begin, end, buffer.literals_, index_delta);
+
+		for (std::size_t i = moved_literals_begin; i < literals_.size(); ++i)
+		{
+			literal_entry_& entry = literals_[i];
+
+			if (lengths_[entry.index]) entry.data_offset = move(entry.data_offset);
+			if (entry.prefix_length) entry.prefix_offset = move(entry.prefix_offset);
+			if (entry.postfix_length) entry.postfix_offset = move(entry.postfix_offset);
+		}
+
+		token_splicing::splice_entries(numbers_, begin, end, buffer.numbers_, index_delta);
+		token_splicing::splice_entries(symbols_, begin, end, buffer.symbols_, index_delta);
+	}
+	std::size_t token_buffer::index_at(std::size_t offset) const noexcept
+	{
+		return static_cast<std::size_t>(std::lower_bound(offsets_.begin(), offsets_.end(), offset) - offsets_.begin());
+	}
+
+	token_buffer::const_iterator token_buffer::begin() const noexcept
+	{
+		return const_iterator(*this, 0);
+	}
+	token_buffer::const_iterator token_buffer::end() const noexcept
+	{
+		return const_iterator(*this, size());
+	}
+
+	std::string_view token_buffer::codes() const noexcept
+	{
+		return codes_;
+	}
+	void token_buffer::codes(const std::string_view& new_codes)
+	{
+		if (new_codes.size() > std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error("The codes of 'dlink::token_buffer' must be shorter than 4 GiB.");
+
+		codes_ = new_codes;
+	}
+
+	const std::vector<std::size_t>& token_buffer::comment_lines() const noexcept
+	{
+		return comment_lines_;
+	}
+	void token_buffer::comment_lines(std::vector<std::size_t>&& new_comment_lines) noexcept
+	{
+		comment_lines_ = std::move(new_comment_lines);
+	}
+	bool token_buffer::in_comment(std::size_t line) const noexcept
+	{
+		return std::binary_search(comment_lines_.begin(), comment_lines_.end(), line);
+	}
+
+	std::uint32_t token_buffer::to_offset_(const std::string_view& view) const noexcept
+	{
+		// Empty views may point anywhere, including outside of the codes.
+		if (view.empty()) return 0;
+
+		return static_cast<std::uint32_t>(view.data() - codes_.data());
+	}
+	const token_buffer::literal_entry_* token_buffer::find_literal_(std::size_t index) const noexcept
+	{
+		const auto iter = std::lower_bound(literals_.begin(), literals_.end(), index,
+			[](const literal_entry_& entry, std::size_t index)
+			{
+				return entry.index < index;
+			});
+
+		return iter != literals_.end() && iter->index == index ? &*iter : nullptr;
+	}
+	const number_value* token_buffer::find_number_(std::size_t index) const noexcept
+	{
+		const auto iter = std::lower_bound(numbers_.begin(), numbers_.end(), index,
+			[](const number_entry_& entry, std::size_t index)
+			{
+				return entry.index < index;
+			});
+
+		return iter != numbers_.end() && iter->index == index ? &iter->value : nullptr;
+	}
+	dlink::symbol token_buffer::find_symbol_(std::size_t index) const noexcept
+	{
+		const auto iter = std::lower_bound(symbols_.begin(), symbols_.end(), index,
+			[](const symbol_entry_& entry, std::size_t index)
+			{
+				return entry.index < index;
+			});
+
+		return iter != symbols_.end() && iter->index == index ? iter->symbol : invalid_symbol;
+	}
+}
\ No newline at end of file
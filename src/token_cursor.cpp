@@ -0,0 +1,202 @@
+#include <Dlink/token_cursor.hpp>
+
+#include <Dlink/exception.hpp>
+
+#include <utility>
+
+namespace dlink
+{
+	token_cursor::token_cursor(const source& source, compiler_metadata& metadata)
+		: source_(source), metadata_(metadata)
+	{
+		if (source.state() < source_state::preprocessed)
+			throw invalid_state("The state of the argument 'source' must be 'dlink::source_state::preprocessed' or higher when 'dlink::token_cursor::token_cursor(const dlink::source&, dlink::compiler_metadata&)' constructor is called.");
+	}
+
+	const token* token_cursor::peek(std::size_t distance)
+	{
+		if (!produce_(distance + 1)) return nullptr;
+
+		return &tokens_[position_ + distance - tokens_base_];
+	}
+	const token* token_cursor::next()
+	{
+		const token* const result = peek();
+
+		if (result)
+		{
+			++position_;
+		}
+
+		return result;
+	}
+	bool token_cursor::eof()
+	{
+		return !peek();
+	}
+	const number_value* token_cursor::number(std::size_t distance)
+	{
+		if (!produce_(distance + 1)) return nullptr;
+
+		const token_value_& value = values_[position_ + distance - tokens_base_];
+		return value.evaluated ? &value.number : nullptr;
+	}
+	dlink::symbol token_cursor::symbol(std::size_t distance)
+	{
+		if (!produce_(distance + 1)) return invalid_symbol;
+
+		return values_[position_ + distance - tokens_base_].symbol;
+	}
+
+	void token_cursor::mark()
+	{
+		marks_.push_back(position_);
+	}
+	void token_cursor::rewind()
+	{
+		if (marks_.empty())
+			throw invalid_state("There must be a mark when 'void dlink::token_cursor::rewind()' method is called.");
+
+		position_ = marks_.back();
+		marks_.pop_back();
+	}
+	void token_cursor::release()
+	{
+		if (marks_.empty())
+			throw invalid_state("There must be a mark when 'void dlink::token_cursor::release()' method is called.");
+
+		marks_.pop_back();
+	}
+
+	std::size_t token_cursor::position() const noexcept
+	{
+		return position_;
+	}
+	bool token_cursor::ok() const noexcept
+	{
+		return state_.ok && tokens_ok_;
+	}
+	bool token_cursor::finished() const noexcept
+	{
+		return finished_;
+	}
+
+	bool token_cursor::produce_(std::size_t count)
+	{
+		trim_();
+
+		while (true)
+		{
+			// The last token kept may still absorb a following '.', so it isn't handed out until another token is kept.
+			const std::size_t stable = tokens_base_ + tokens_.size() - (finished_ || tokens_.empty() ? 0 : 1);
+			if (stable >= position_ + count) return true;
+			else if (finished_) return false;
+
+			// Numbers look up to two raw tokens ahead, exactly as far as lex_source would see them.
+			if (!lines_lexed_ && raw_tokens_.size() - raw_index_ < 3)
+			{
+				lex_line_();
+			}
+			else if (raw_index_ < raw_tokens_.size())
+			{
+				const std::size_t cur_index = raw_index_;
+
+				if (lexer::lex_token_(source_, token_messages_, raw_tokens_, raw_index_, tokens_.empty() ? nullptr : &tokens_.back(), tokens_ok_))
+				{
+					if (!tokens_.empty())
+					{
+						finalize_(tokens_.size() - 1);
+					}
+
+					tokens_.push_back(raw_tokens_[cur_index]);
+					values_.emplace_back();
+				}
+
+				++raw_index_;
+			}
+			else
+			{
+				finish_();
+			}
+		}
+	}
+	void token_cursor::lex_line_()
+	{
+		const std::vector<preprocessed_line>& preprocessed_codes = source_.preprocessed_codes();
+
+		if (line_ < preprocessed_codes.size())
+		{
+			const preprocessed_line& preprocessed = preprocessed_codes[line_++];
+			lexer::lex_line_(source_, line_messages_, preprocessed.data, preprocessed.line, source_.lines().line_begin(preprocessed.line), state_, raw_tokens_);
+		}
+		else
+		{
+			lexer::lex_end_(source_, line_messages_, state_);
+			lines_lexed_ = true;
+		}
+	}
+	void token_cursor::finish_()
+	{
+		finished_ = true;
+
+		if (!tokens_.empty())
+		{
+			finalize_(tokens_.size() - 1);
+		}
+
+		for (message_ptr& message : line_messages_)
+		{
+			metadata_.messages().push_back(std::move(message));
+		}
+
+		// lex_source never gets to the tokens when a line failed, so neither do their diagnostics.
+		if (state_.ok)
+		{
+			for (message_ptr& message : token_messages_)
+			{
+				metadata_.messages().push_back(std::move(message));
+			}
+			for (message_ptr& message : number_messages_)
+			{
+				metadata_.messages().push_back(std::move(message));
+			}
+		}
+
+		line_messages_.clear();
+		token_messages_.clear();
+		number_messages_.clear();
+	}
+	void token_cursor::finalize_(std::size_t index)
+	{
+		const token& token = tokens_[index];
+		token_value_& value = values_[index];
+
+		if (token.type() == token_type::identifier)
+		{
+			value.symbol = metadata_.interner().intern(token.data());
+			metadata_.interner().add_lookups(1);
+		}
+		else if (is_number(token.type()))
+		{
+			value.evaluated = lexer::evaluate_number_(source_, number_messages_, token, value.number, tokens_ok_);
+		}
+	}
+	void token_cursor::trim_()
+	{
+		static constexpr std::size_t min_trimmed = 64;
+
+		const std::size_t tokens_trimmed = (marks_.empty() ? position_ : marks_.front()) - tokens_base_;
+
+		if (tokens_trimmed >= min_trimmed && tokens_trimmed * 2 >= tokens_.size())
+		{
+			tokens_.erase(tokens_.begin(), tokens_.begin() + tokens_trimmed);
+			values_.erase(values_.begin(), values_.begin() + tokens_trimmed);
+			tokens_base_ += tokens_trimmed;
+		}
+		if (raw_index_ >= min_trimmed && raw_index_ * 2 >= raw_tokens_.size())
+		{
+			raw_tokens_.erase(raw_tokens_.begin(), raw_tokens_.begin() + raw_index_);
+			raw_index_ = 0;
+		}
+	}
+}
\ No newline at end of file